@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy.h"
+#include "dizzy/arena.h"
+
+/* Compares scratch buffers for a short chain of nodes processed a block at
+ * a time: a std::vector made per node per block, and spans from an Arena
+ * freed by a Scope at the end of each block */
+
+namespace {
+
+const size_t samples = 1 << 16;
+const size_t nodes = 8;
+const int repeats = 200;
+
+volatile float sink;
+
+template <typename F>
+double nsPerSample(F run, size_t samples) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / samples;
+}
+
+void compare(size_t block) {
+    std::vector<float> x(samples);
+    for (size_t i = 0; i < samples; i++) {
+        x[i] = std::sin(0.01f * i);
+    }
+
+    double vectors = nsPerSample([&]() {
+        float total = 0.0f;
+        for (size_t i = 0; i + block <= samples; i += block) {
+            std::vector<float> in(x.begin() + i, x.begin() + i + block);
+            for (size_t n = 0; n < nodes; n++) {
+                std::vector<float> out(block);
+                dizzy::mul(out, in, 0.99f);
+                in.swap(out);
+            }
+            total += in[0];
+        }
+        sink = total;
+    }, samples);
+
+    dizzy::Arena arena((nodes + 1) * block * sizeof(float));
+    double arenas = nsPerSample([&]() {
+        float total = 0.0f;
+        for (size_t i = 0; i + block <= samples; i += block) {
+            dizzy::Arena::Scope scope(arena);
+            dizzy::Span in = arena.allocate(block);
+            std::copy(x.begin() + i, x.begin() + i + block, in.begin());
+            for (size_t n = 0; n < nodes; n++) {
+                dizzy::Span out = arena.allocate(block);
+                dizzy::mul(out, in, 0.99f);
+                in = out;
+            }
+            total += in[0];
+        }
+        sink = total;
+    }, samples);
+
+    std::printf("%4zu sample blocks: vector per node %5.2f ns/sample, "
+                "Arena %5.2f (%.1fx)\n", block, vectors, arenas,
+                vectors / arenas);
+}
+
+}
+
+int main() {
+    size_t blocks[] = {32, 64, 256, 1024};
+    for (size_t b : blocks) {
+        compare(b);
+    }
+    return 0;
+}
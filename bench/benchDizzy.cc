@@ -0,0 +1,396 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dizzy.h"
+
+/* Microbenchmarks of every public dizzy.h function, swept over buffer sizes
+ * from 64 to 1M samples and over container types:
+ *
+ *   array       std::array<float, N>, heap allocated
+ *   vector      std::vector<float>
+ *   aligned     std::vector with 64 byte aligned storage
+ *   misaligned  std::vector with storage 4 bytes past a 64 byte boundary
+ *   span        dizzy::Span over plain memory
+ *   strided     dizzy::StridedSpan over every other element, which takes
+ *               the generic iterator paths
+ *   double      std::vector<double>, with the double kernels where there
+ *               are any
+ *
+ * Usage: benchDizzy [--json FILE] [--filter TEXT] [--container NAME]
+ *                   [--max-size N] [--min-time MS] [--level LEVEL]
+ *
+ * Results are printed as a table, and written as JSON to FILE ("-" for
+ * stdout) so that runs can be diffed. */
+
+namespace {
+
+/* Allocator returning storage Offset bytes past a 64 byte boundary */
+template <typename T, size_t Offset>
+struct OffsetAllocator {
+    typedef T value_type;
+
+    OffsetAllocator() {}
+    template <typename U>
+    OffsetAllocator(const OffsetAllocator<U, Offset> &) {}
+
+    template <typename U>
+    struct rebind { typedef OffsetAllocator<U, Offset> other; };
+
+    T *allocate(size_t n) {
+        char *p = static_cast<char *>(std::malloc(n * sizeof(T) + 128));
+        char *aligned = p + 64 - reinterpret_cast<uintptr_t>(p) % 64;
+        aligned += Offset;
+        std::memcpy(aligned - Offset - sizeof(char *), &p, sizeof(char *));
+        return reinterpret_cast<T *>(aligned);
+    }
+
+    void deallocate(T *x, size_t) {
+        char *p;
+        std::memcpy(&p, reinterpret_cast<char *>(x) - Offset - sizeof(char *),
+                    sizeof(char *));
+        std::free(p);
+    }
+
+    bool operator==(const OffsetAllocator &) const { return true; }
+    bool operator!=(const OffsetAllocator &) const { return false; }
+};
+
+/* Backing memory for the span containers */
+std::vector<std::unique_ptr<float[]> > storage;
+
+template <typename T>
+struct Make {
+    static T *make(size_t n) { return new T(n); }
+};
+
+template <>
+struct Make<dizzy::Span> {
+    static dizzy::Span *make(size_t n) {
+        storage.push_back(std::unique_ptr<float[]>(new float[n]()));
+        return new dizzy::Span(storage.back().get(), n);
+    }
+};
+
+/* Every other element of an interleaved buffer */
+template <>
+struct Make<dizzy::StridedSpan> {
+    static dizzy::StridedSpan *make(size_t n) {
+        storage.push_back(std::unique_ptr<float[]>(new float[2 * n]()));
+        return new dizzy::StridedSpan(storage.back().get(), n, 2);
+    }
+};
+
+template <size_t N>
+struct Make<std::array<float, N> > {
+    static std::array<float, N> *make(size_t) {
+        return new std::array<float, N>();
+    }
+};
+
+struct Options {
+    std::string json;
+    std::string filter;
+    std::string container;
+    size_t maxSize;
+    double minTime;
+};
+
+struct Result {
+    std::string function;
+    std::string container;
+    size_t size;
+    double nsPerSample;
+    double gbPerSecond;
+};
+
+Options options = {"", "", "", 1 << 20, 0.01};
+std::vector<Result> results;
+FILE *table = stdout;
+/* Bytes per element of the containers being run */
+size_t elementBytes = sizeof(float);
+volatile float sink;
+
+/* Time a case for at least the minimum time, keeping the best of three
+ * runs.  floats is the number of elements read and written per sample. */
+void measure(const char *function, const char *container, size_t size,
+             size_t floats, const std::function<void()> &run) {
+    if (!options.filter.empty() &&
+        std::string(function).find(options.filter) == std::string::npos) {
+        return;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    run();
+
+    size_t calls = 1;
+    double best = 0.0;
+    for (int attempt = 0; attempt < 3; attempt++) {
+        double elapsed;
+        while (true) {
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < calls; i++) {
+                run();
+            }
+            std::chrono::duration<double> d = Clock::now() - start;
+            elapsed = d.count();
+            if (elapsed >= options.minTime) {
+                break;
+            }
+            calls *= 2;
+        }
+        double perCall = elapsed / calls;
+        if (attempt == 0 || perCall < best) {
+            best = perCall;
+        }
+    }
+
+    Result result = {function, container, size, best * 1e9 / size,
+                     floats * elementBytes * size / best * 1e-9};
+    results.push_back(result);
+    std::fprintf(table, "%-22s %-11s %8zu %10.3f ns/sample %8.2f GB/s\n",
+                 function, container, size, result.nsPerSample,
+                 result.gbPerSecond);
+}
+
+template <typename T>
+void runAll(const char *container, size_t n) {
+    std::unique_ptr<T> a(Make<T>::make(n)), b(Make<T>::make(n));
+    std::unique_ptr<T> c(Make<T>::make(n)), d(Make<T>::make(n));
+    std::unique_ptr<T> e(Make<T>::make(n)), f(Make<T>::make(n));
+    std::unique_ptr<T> g(Make<T>::make(n)), h(Make<T>::make(n));
+    T &dst = *a, &dst2 = *b, &x = *c, &y = *d, &z = *e, &w = *f;
+    T &v = *g, &t = *h;
+    elementBytes = sizeof(dizzy::detail::Value<T>);
+
+    for (size_t i = 0; i < n; i++) {
+        x[i] = 0.1f + 0.8f * ((i * 7919) % 1000) / 1000.0f;
+        y[i] = 0.2f + 0.7f * ((i * 104729) % 997) / 997.0f;
+        z[i] = 0.3f + 0.5f * ((i * 31) % 101) / 101.0f;
+        w[i] = 0.4f + 0.4f * ((i * 17) % 89) / 89.0f;
+        v[i] = 1.5f - x[i];
+        t[i] = (n - 1.0f) * ((i * 7) % n) / n;
+    }
+
+    const char *k = container;
+    measure("add(vs)", k, n, 2, [&]() { dizzy::add(dst, x, 0.5f); });
+    measure("add(vv)", k, n, 3, [&]() { dizzy::add(dst, x, y); });
+    measure("sub(vs)", k, n, 2, [&]() { dizzy::sub(dst, x, 0.5f); });
+    measure("sub(vv)", k, n, 3, [&]() { dizzy::sub(dst, x, y); });
+    measure("mul(vs)", k, n, 2, [&]() { dizzy::mul(dst, x, 0.5f); });
+    measure("mul(vv)", k, n, 3, [&]() { dizzy::mul(dst, x, y); });
+    measure("div(vs)", k, n, 2, [&]() { dizzy::div(dst, x, 0.5f); });
+    measure("div(vv)", k, n, 3, [&]() { dizzy::div(dst, x, y); });
+    measure("madd(vvs)", k, n, 3, [&]() { dizzy::madd(dst, x, y, 0.5f); });
+    measure("madd(vvv)", k, n, 4, [&]() { dizzy::madd(dst, x, y, z); });
+    measure("mulCplx(vs)", k, n, 4, [&]() {
+        dizzy::mulCplx(dst, dst2, x, y, 0.5f, 0.25f);
+    });
+    measure("mulCplx(vv)", k, n, 6, [&]() {
+        dizzy::mulCplx(dst, dst2, x, y, z, w);
+    });
+    measure("divCplx(vs)", k, n, 4, [&]() {
+        dizzy::divCplx(dst, dst2, x, y, 0.5f, 0.25f);
+    });
+    measure("divCplx(vv)", k, n, 6, [&]() {
+        dizzy::divCplx(dst, dst2, x, y, z, w);
+    });
+    measure("maddCplx", k, n, 8, [&]() {
+        dizzy::maddCplx(dst, dst2, x, y, z, w, v, t);
+    });
+    measure("abs", k, n, 2, [&]() { dizzy::abs(dst, x); });
+    measure("absCplx", k, n, 3, [&]() { dizzy::absCplx(dst, x, y); });
+    measure("sin", k, n, 2, [&]() { dizzy::sin(dst, x); });
+    measure("cos", k, n, 2, [&]() { dizzy::cos(dst, x); });
+    measure("tan", k, n, 2, [&]() { dizzy::tan(dst, x); });
+    measure("acos", k, n, 2, [&]() { dizzy::acos(dst, x); });
+    measure("asin", k, n, 2, [&]() { dizzy::asin(dst, x); });
+    measure("atan", k, n, 2, [&]() { dizzy::atan(dst, x); });
+    measure("atan2", k, n, 3, [&]() { dizzy::atan2(dst, x, y); });
+    measure("ceil", k, n, 2, [&]() { dizzy::ceil(dst, v); });
+    measure("floor", k, n, 2, [&]() { dizzy::floor(dst, v); });
+    measure("round", k, n, 2, [&]() { dizzy::round(dst, v); });
+    measure("exp", k, n, 2, [&]() { dizzy::exp(dst, x); });
+    measure("log", k, n, 2, [&]() { dizzy::log(dst, x); });
+    measure("pow(vs)", k, n, 2, [&]() { dizzy::pow(dst, x, 2.5f); });
+    measure("pow(vv)", k, n, 3, [&]() { dizzy::pow(dst, x, y); });
+    measure("sqrt", k, n, 2, [&]() { dizzy::sqrt(dst, x); });
+    measure("max", k, n, 1, [&]() { sink = dizzy::max(x); });
+    measure("min", k, n, 1, [&]() { sink = dizzy::min(x); });
+    measure("sum", k, n, 1, [&]() { sink = dizzy::sum(x); });
+    measure("dot", k, n, 2, [&]() { sink = dizzy::dot(x, y); });
+    measure("sumOfSquares", k, n, 1, [&]() {
+        sink = dizzy::sumOfSquares(x);
+    });
+    measure("rms", k, n, 1, [&]() { sink = dizzy::rms(x); });
+    measure("minmax", k, n, 1, [&]() { sink = dizzy::minmax(x).first; });
+    measure("argmin", k, n, 1, [&]() { sink = dizzy::argmin(x); });
+    measure("argmax", k, n, 1, [&]() { sink = dizzy::argmax(x); });
+    measure("random", k, n, 1, [&]() { dizzy::random(dst, -1.0f, 1.0f); });
+    measure("clamp", k, n, 2, [&]() { dizzy::clamp(dst, x, 0.3f, 0.6f); });
+    measure("fract", k, n, 2, [&]() { dizzy::fract(dst, v); });
+    measure("ramp", k, n, 1, [&]() { dizzy::ramp(dst, -1.0f, 1.0f); });
+    measure("sign", k, n, 2, [&]() { dizzy::sign(dst, v); });
+    measure("sampleLinear", k, n, 3, [&]() {
+        dizzy::sampleLinear(dst, x, t);
+    });
+    measure("sampleLinear(rep)", k, n, 3, [&]() {
+        dizzy::sampleLinear(dst, x, t, true);
+    });
+    measure("sampleCubic", k, n, 3, [&]() {
+        dizzy::sampleCubic(dst, x, t);
+    });
+    measure("sampleCubic(rep)", k, n, 3, [&]() {
+        dizzy::sampleCubic(dst, x, t, true);
+    });
+    measure("pack(2)", k, n, 2, [&]() { dizzy::pack(dst, 0, 2, &x, &y); });
+    measure("unpack(2)", k, n, 2, [&]() {
+        dizzy::unpack(x, 0, 2, &dst, &dst2);
+    });
+
+    const char *tiers[] = {"low", "medium", "high"};
+    dizzy::approx::Precision precisions[] = {dizzy::approx::LOW,
+                                             dizzy::approx::MEDIUM,
+                                             dizzy::approx::HIGH};
+    for (int i = 0; i < 3; i++) {
+        dizzy::approx::Precision p = precisions[i];
+        std::string s = tiers[i];
+        measure(("approx::sin/" + s).c_str(), k, n, 2, [&]() {
+            dizzy::approx::sin(dst, x, p);
+        });
+        measure(("approx::cos/" + s).c_str(), k, n, 2, [&]() {
+            dizzy::approx::cos(dst, x, p);
+        });
+        measure(("approx::tan/" + s).c_str(), k, n, 2, [&]() {
+            dizzy::approx::tan(dst, x, p);
+        });
+        measure(("approx::exp/" + s).c_str(), k, n, 2, [&]() {
+            dizzy::approx::exp(dst, x, p);
+        });
+        measure(("approx::log/" + s).c_str(), k, n, 2, [&]() {
+            dizzy::approx::log(dst, x, p);
+        });
+        measure(("approx::pow(vs)/" + s).c_str(), k, n, 2, [&]() {
+            dizzy::approx::pow(dst, x, 2.5f, p);
+        });
+        measure(("approx::pow(vv)/" + s).c_str(), k, n, 3, [&]() {
+            dizzy::approx::pow(dst, x, y, p);
+        });
+    }
+}
+
+bool wanted(const char *container, size_t n) {
+    return n <= options.maxSize &&
+           (options.container.empty() || options.container == container);
+}
+
+template <size_t N>
+void runSize() {
+    if (wanted("array", N)) {
+        runAll<std::array<float, N> >("array", N);
+    }
+    if (wanted("vector", N)) {
+        runAll<std::vector<float> >("vector", N);
+    }
+    if (wanted("aligned", N)) {
+        runAll<std::vector<float, OffsetAllocator<float, 0> > >("aligned",
+                                                                N);
+    }
+    if (wanted("misaligned", N)) {
+        runAll<std::vector<float, OffsetAllocator<float, 4> > >(
+                "misaligned", N);
+    }
+    if (wanted("span", N)) {
+        runAll<dizzy::Span>("span", N);
+    }
+    if (wanted("strided", N)) {
+        runAll<dizzy::StridedSpan>("strided", N);
+    }
+    if (wanted("double", N)) {
+        runAll<std::vector<double> >("double", N);
+    }
+    storage.clear();
+}
+
+void writeJson(FILE *file) {
+    const char *levels[] = {"scalar", "sse2", "avx2", "avx512"};
+    std::fprintf(file, "{\n  \"simd\": \"%s\",\n  \"results\": [\n",
+                 levels[dizzy::simd::level()]);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        std::fprintf(file, "    {\"function\": \"%s\", \"container\": \"%s\", "
+                     "\"size\": %zu, \"ns_per_sample\": %.6g, "
+                     "\"gb_per_s\": %.6g}%s\n", r.function.c_str(),
+                     r.container.c_str(), r.size, r.nsPerSample,
+                     r.gbPerSecond, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i], value = argv[i + 1];
+        if (option == "--json") {
+            options.json = value;
+        }
+        else if (option == "--filter") {
+            options.filter = value;
+        }
+        else if (option == "--container") {
+            options.container = value;
+        }
+        else if (option == "--max-size") {
+            options.maxSize = std::strtoul(value.c_str(), NULL, 10);
+        }
+        else if (option == "--min-time") {
+            options.minTime = std::atof(value.c_str()) / 1000.0;
+        }
+        else if (option == "--level") {
+            const char *levels[] = {"scalar", "sse2", "avx2", "avx512"};
+            for (int l = 0; l < 4; l++) {
+                if (value == levels[l]) {
+                    dizzy::simd::setLevel(dizzy::simd::Level(l));
+                }
+            }
+        }
+        else {
+            std::fprintf(stderr, "unknown option %s\n", option.c_str());
+            return 1;
+        }
+    }
+
+    if (options.json == "-") {
+        table = stderr;
+    }
+
+    runSize<64>();
+    runSize<256>();
+    runSize<1024>();
+    runSize<4096>();
+    runSize<16384>();
+    runSize<65536>();
+    runSize<262144>();
+    runSize<1048576>();
+
+    if (options.json == "-") {
+        writeJson(stdout);
+    }
+    else if (!options.json.empty()) {
+        FILE *file = std::fopen(options.json.c_str(), "w");
+        if (!file) {
+            std::fprintf(stderr, "can't write %s\n", options.json.c_str());
+            return 1;
+        }
+        writeJson(file);
+        std::fclose(file);
+    }
+    return 0;
+}
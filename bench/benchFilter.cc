@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy/filter.h"
+
+/* Compares the block biquad kernels against a naive per-sample direct form
+ * I loop, for a mono cascade and for a bank of independent channels */
+
+namespace {
+
+const size_t frames = 4096;
+const size_t sections = 4;
+const int repeats = 200;
+
+/* Per-sample direct form I, one channel and one section at a time */
+void naive(std::vector<float> &dst, const std::vector<float> &x,
+           const std::vector<dizzy::Biquad> &biquads, size_t channels,
+           std::vector<float> &history) {
+    for (size_t f = 0; f < frames; f++) {
+        for (size_t c = 0; c < channels; c++) {
+            float in = x[f * channels + c];
+            for (size_t s = 0; s < sections; s++) {
+                const dizzy::Biquad &q = biquads[s];
+                float *h = &history[4 * (s * channels + c)];
+                float out = q.b0 * in + q.b1 * h[0] + q.b2 * h[1] -
+                            q.a1 * h[2] - q.a2 * h[3];
+                h[1] = h[0];
+                h[0] = in;
+                h[3] = h[2];
+                h[2] = out;
+                in = out;
+            }
+            dst[f * channels + c] = in;
+        }
+    }
+}
+
+template <typename F>
+double nsPerSample(F run, size_t samples) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / samples;
+}
+
+void compare(size_t channels) {
+    size_t samples = frames * channels;
+    std::vector<float> x(samples), y(samples), history(4 * sections * channels);
+    for (size_t i = 0; i < samples; i++) {
+        x[i] = std::sin(0.01f * i);
+    }
+
+    std::vector<dizzy::Biquad> biquads;
+    dizzy::BiquadFilter filter(sections, channels);
+    for (size_t s = 0; s < sections; s++) {
+        biquads.push_back(dizzy::Biquad::peak(0.01f * (s + 1), 1.0f, 3.0f));
+        filter.set(s, biquads.back());
+    }
+
+    double reference = nsPerSample([&]() {
+        naive(y, x, biquads, channels, history);
+    }, samples);
+    double block = nsPerSample([&]() { filter.filter(y, x); }, samples);
+
+    std::printf("%2zu channels x %zu sections: naive %6.2f ns/sample, "
+                "BiquadFilter %6.2f ns/sample (%.1fx)\n", channels, sections,
+                reference, block, reference / block);
+}
+
+}
+
+int main() {
+    size_t channels[] = {1, 2, 4, 8, 16, 32};
+    for (size_t c : channels) {
+        compare(c);
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy.h"
+
+/* Compares the fixed length kernels std::arrays take against the runtime
+ * length kernels, reached by viewing the same arrays through spans, over a
+ * set of blocks small enough to stay in L1 */
+
+namespace {
+
+const size_t blocks = 8;
+const int repeats = 200000;
+
+volatile float sink;
+
+template <typename F>
+double nsPerCall(F run) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / blocks;
+}
+
+template <size_t N>
+void compare() {
+    typedef std::array<float, N> Block;
+    std::vector<Block> x(blocks), y(blocks), dst(blocks);
+    std::vector<dizzy::Span> xs, ys, dsts;
+    for (size_t b = 0; b < blocks; b++) {
+        x[b].fill(1.0f + b);
+        y[b].fill(0.5f);
+        xs.push_back(dizzy::Span(x[b]));
+        ys.push_back(dizzy::Span(y[b]));
+        dsts.push_back(dizzy::Span(dst[b]));
+    }
+
+    double spanMul = nsPerCall([&]() {
+        for (size_t b = 0; b < blocks; b++) {
+            dizzy::mul(dsts[b], xs[b], ys[b]);
+        }
+        sink = dst[0][0];
+    });
+    double fixedMul = nsPerCall([&]() {
+        for (size_t b = 0; b < blocks; b++) {
+            dizzy::mul(dst[b], x[b], y[b]);
+        }
+        sink = dst[0][0];
+    });
+    double spanMadd = nsPerCall([&]() {
+        for (size_t b = 0; b < blocks; b++) {
+            dizzy::madd(dsts[b], dsts[b], xs[b], 0.5f);
+        }
+        sink = dst[0][0];
+    });
+    double fixedMadd = nsPerCall([&]() {
+        for (size_t b = 0; b < blocks; b++) {
+            dizzy::madd(dst[b], dst[b], x[b], 0.5f);
+        }
+        sink = dst[0][0];
+    });
+
+    std::printf("%4zu samples: mul span %5.2f, array %5.2f ns/call; "
+                "madd span %5.2f, array %5.2f\n", N, spanMul, fixedMul,
+                spanMadd, fixedMadd);
+}
+
+}
+
+int main() {
+    compare<16>();
+    compare<64>();
+    compare<100>();
+    compare<128>();
+    compare<256>();
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy/format.h"
+
+/* Compares encode and decode against a per-sample loop which converts,
+ * saturates and interleaves each channel in turn */
+
+namespace {
+
+const size_t frames = 4096;
+const int repeats = 2000;
+
+void naiveEncode(int16_t *dst, const std::vector<float> *const *srcs,
+                 size_t channels) {
+    for (size_t c = 0; c < channels; c++) {
+        const std::vector<float> &src = *srcs[c];
+        for (size_t i = 0; i < src.size(); i++) {
+            float v = std::round(src[i] * 32768.0f);
+            v = std::max(-32768.0f, std::min(v, 32767.0f));
+            dst[i * channels + c] = (int16_t) v;
+        }
+    }
+}
+
+void naiveDecode(std::vector<float> *const *dsts, size_t channels,
+                 const int16_t *src) {
+    for (size_t c = 0; c < channels; c++) {
+        std::vector<float> &dst = *dsts[c];
+        for (size_t i = 0; i < dst.size(); i++) {
+            dst[i] = src[i * channels + c] * (1.0f / 32768.0f);
+        }
+    }
+}
+
+template <typename F>
+double nsPerSample(F run, size_t samples) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / samples;
+}
+
+void compare(size_t channels) {
+    std::vector<std::vector<float> > planar(channels,
+                                            std::vector<float>(frames));
+    std::vector<const std::vector<float> *> srcs;
+    std::vector<std::vector<float> *> dsts;
+    for (size_t c = 0; c < channels; c++) {
+        for (size_t i = 0; i < frames; i++) {
+            planar[c][i] = std::sin(0.01f * (i + c));
+        }
+        srcs.push_back(&planar[c]);
+        dsts.push_back(&planar[c]);
+    }
+    std::vector<int16_t> interleaved(frames * channels);
+    std::vector<unsigned char> int24(frames * channels * 3);
+    size_t samples = frames * channels;
+    dizzy::Dither dither(channels);
+
+    double naive = nsPerSample([&]() {
+        naiveEncode(interleaved.data(), srcs.data(), channels);
+    }, samples);
+    double encoded = nsPerSample([&]() {
+        dizzy::encode(interleaved.data(), dizzy::INT16, srcs.data(),
+                      channels);
+    }, samples);
+    double dithered = nsPerSample([&]() {
+        dizzy::encode(interleaved.data(), dizzy::INT16, srcs.data(),
+                      channels, &dither);
+    }, samples);
+    double packed = nsPerSample([&]() {
+        dizzy::encode(int24.data(), dizzy::INT24, srcs.data(), channels);
+    }, samples);
+    double naiveOut = nsPerSample([&]() {
+        naiveDecode(dsts.data(), channels, interleaved.data());
+    }, samples);
+    double decoded = nsPerSample([&]() {
+        dizzy::decode(dsts.data(), channels, interleaved.data(),
+                      dizzy::INT16);
+    }, samples);
+
+    std::printf("%zu channels: int16 encode %5.2f -> %5.2f ns/sample (%.1fx), "
+                "dithered %5.2f, int24 %5.2f; decode %5.2f -> %5.2f (%.1fx)\n",
+                channels, naive, encoded, naive / encoded, dithered, packed,
+                naiveOut, decoded, naiveOut / decoded);
+}
+
+}
+
+int main() {
+    size_t channels[] = {1, 2, 6, 8};
+    for (size_t c : channels) {
+        compare(c);
+    }
+    return 0;
+}
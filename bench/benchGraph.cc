@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy/graph.h"
+
+/* Compares a 200 node chain run as a Graph against the same calls made by
+ * hand with a buffer per edge, for chains of elementwise nodes only and
+ * with a biquad every tenth node */
+
+namespace {
+
+const size_t block = 256;
+const size_t nodes = 200;
+const int repeats = 2000;
+
+volatile float sink;
+
+template <typename F>
+double nsPerSample(F run) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / block;
+}
+
+void compare(bool filters) {
+    std::vector<float> x(block);
+    for (size_t i = 0; i < block; i++) {
+        x[i] = std::sin(0.01f * i);
+    }
+    dizzy::Biquad lowpass = dizzy::Biquad::lowpass(0.1f, 0.7f);
+
+    /* Node i scales, offsets or filters its predecessor, and mixes in the
+     * input every third node */
+    std::vector<std::vector<float> > edges(nodes, std::vector<float>(block));
+    std::vector<dizzy::BiquadFilter> biquads(nodes, dizzy::BiquadFilter(1));
+    dizzy::Graph graph(block);
+    dizzy::Graph::Node in = graph.input(), n = in;
+    for (size_t i = 0; i < nodes; i++) {
+        biquads[i].set(0, lowpass);
+        if (filters && i % 10 == 9) {
+            n = graph.biquad(n, std::vector<dizzy::Biquad>(1, lowpass));
+        }
+        else if (i % 3 == 2) {
+            n = graph.madd(n, in, 0.01f);
+        }
+        else {
+            n = i % 3 ? graph.add(n, 0.001f) : graph.mul(n, 0.999f);
+        }
+    }
+    graph.output(n);
+    graph.compile();
+
+    double byHand = nsPerSample([&]() {
+        const std::vector<float> *previous = &x;
+        for (size_t i = 0; i < nodes; i++) {
+            std::vector<float> &y = edges[i];
+            if (filters && i % 10 == 9) {
+                biquads[i].filter(y, *previous);
+            }
+            else if (i % 3 == 2) {
+                dizzy::madd(y, *previous, x, 0.01f);
+            }
+            else if (i % 3) {
+                dizzy::add(y, *previous, 0.001f);
+            }
+            else {
+                dizzy::mul(y, *previous, 0.999f);
+            }
+            previous = &y;
+        }
+        sink = edges.back()[0];
+    });
+
+    std::vector<float> y(block);
+    std::vector<dizzy::Span> inputs = {dizzy::Span(x)};
+    std::vector<dizzy::Span> outputs = {dizzy::Span(y)};
+    double graphed = nsPerSample([&]() {
+        graph.process(outputs, inputs);
+        sink = y[0];
+    });
+
+    std::printf("%s: by hand %6.2f ns/sample with %zu buffers, Graph "
+                "%6.2f with %zu buffers in %zu passes (%.1fx)\n",
+                filters ? "with biquads " : "elementwise  ", byHand, nodes,
+                graphed, graph.numBuffers(), graph.numTasks(),
+                byHand / graphed);
+}
+
+}
+
+int main() {
+    compare(false);
+    compare(true);
+    return 0;
+}
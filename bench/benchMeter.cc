@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy/meter.h"
+
+/* Compares Meter against a per-sample loop doing the same work: peak,
+ * energy, two K-weighting biquads and the 48 tap true peak interpolator,
+ * for the channel counts of mono, stereo, 5.1 and 7.1.4 streams */
+
+namespace {
+
+const float rate = 48000.0f;
+const size_t frames = 4800;
+const int repeats = 200;
+
+volatile float sink;
+
+struct NaiveChannel {
+    float history[12];
+    float z[4];
+    float peak;
+    float truePeak;
+    double energy;
+    double weighted;
+};
+
+void naiveMeter(std::vector<NaiveChannel> &state, const dizzy::Biquad *k,
+                const std::vector<float> &x) {
+    size_t channels = state.size();
+    for (size_t i = 0; i < x.size() / channels; i++) {
+        for (size_t c = 0; c < channels; c++) {
+            NaiveChannel &s = state[c];
+            float v = x[i * channels + c];
+            s.peak = std::max(s.peak, std::fabs(v));
+            s.energy += v * v;
+
+            float w = v;
+            for (size_t j = 0; j < 2; j++) {
+                float *z = s.z + 2 * j;
+                float y = k[j].b0 * w + z[0];
+                z[0] = k[j].b1 * w - k[j].a1 * y + z[1];
+                z[1] = k[j].b2 * w - k[j].a2 * y;
+                w = y;
+            }
+            s.weighted += w * w;
+
+            std::copy(s.history + 1, s.history + 12, s.history);
+            s.history[11] = v;
+            for (size_t p = 0; p < 4; p++) {
+                float y = 0.0f;
+                for (size_t t = 0; t < 12; t++) {
+                    y += dizzy::detail::truePeakFilter[p][t] *
+                         s.history[11 - t];
+                }
+                s.truePeak = std::max(s.truePeak, std::fabs(y));
+            }
+        }
+    }
+}
+
+template <typename F>
+double nsPerSample(F run, size_t samples) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / samples;
+}
+
+void compare(size_t channels) {
+    std::vector<float> x(frames * channels);
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = std::sin(0.01f * i) * 0.5f;
+    }
+    size_t samples = x.size();
+
+    dizzy::Biquad k[] = {dizzy::detail::kShelf(rate),
+                         dizzy::detail::kHighpass(rate)};
+    std::vector<NaiveChannel> state(channels, NaiveChannel());
+    double naive = nsPerSample([&]() {
+        naiveMeter(state, k, x);
+        sink = state[0].truePeak;
+    }, samples);
+
+    dizzy::Meter meter(channels, rate);
+    double metered = nsPerSample([&]() {
+        meter.process(x);
+        sink = meter.truePeak(0);
+    }, samples);
+
+    std::printf("%2zu channels: naive %6.2f ns/sample, Meter %6.2f (%.1fx)\n",
+                channels, naive, metered, naive / metered);
+}
+
+}
+
+int main() {
+    size_t channels[] = {1, 2, 6, 12};
+    for (size_t c : channels) {
+        compare(c);
+    }
+    return 0;
+}
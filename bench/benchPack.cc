@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy.h"
+
+/* Compares pack and unpack against one strided pass per channel, for the
+ * usual device layouts at a few buffer sizes */
+
+namespace {
+
+const int repeats = 2000;
+
+void naivePack(std::vector<float> &dst, size_t stride,
+               const std::vector<float> *const *srcs, size_t channels) {
+    for (size_t c = 0; c < channels; c++) {
+        const std::vector<float> &src = *srcs[c];
+        for (size_t i = 0; i < src.size(); i++) {
+            dst[i * stride + c] = src[i];
+        }
+    }
+}
+
+void naiveUnpack(const std::vector<float> &src, size_t stride,
+                 std::vector<float> *const *dsts, size_t channels) {
+    for (size_t c = 0; c < channels; c++) {
+        std::vector<float> &dst = *dsts[c];
+        for (size_t i = 0; i < dst.size(); i++) {
+            dst[i] = src[i * stride + c];
+        }
+    }
+}
+
+template <typename F>
+double nsPerSample(F run, size_t samples) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / samples;
+}
+
+void compare(size_t channels, size_t stride, size_t frames) {
+    std::vector<std::vector<float> > planar(channels,
+                                            std::vector<float>(frames, 1.0f));
+    std::vector<const std::vector<float> *> srcs;
+    std::vector<std::vector<float> *> dsts;
+    for (size_t c = 0; c < channels; c++) {
+        srcs.push_back(&planar[c]);
+        dsts.push_back(&planar[c]);
+    }
+    std::vector<float> interleaved(frames * stride, 1.0f);
+    size_t samples = frames * channels;
+
+    double naive = nsPerSample([&]() {
+        naivePack(interleaved, stride, srcs.data(), channels);
+    }, samples);
+    double packed = nsPerSample([&]() {
+        dizzy::pack(interleaved, 0, stride, srcs.data(), channels);
+    }, samples);
+    double naiveOut = nsPerSample([&]() {
+        naiveUnpack(interleaved, stride, dsts.data(), channels);
+    }, samples);
+    double unpacked = nsPerSample([&]() {
+        dizzy::unpack(interleaved, 0, stride, dsts.data(), channels);
+    }, samples);
+
+    std::printf("%zu of %zu channels x %5zu frames: pack %5.2f -> %5.2f "
+                "ns/sample (%.1fx), unpack %5.2f -> %5.2f (%.1fx)\n",
+                channels, stride, frames, naive, packed, naive / packed,
+                naiveOut, unpacked, naiveOut / unpacked);
+}
+
+}
+
+int main() {
+    size_t layouts[][2] = {{2, 2}, {4, 4}, {6, 6}, {8, 8}, {2, 8}, {16, 16}};
+    size_t frames[] = {256, 4096, 65536};
+    for (auto &layout : layouts) {
+        for (size_t f : frames) {
+            compare(layout[0], layout[1], f);
+        }
+    }
+    return 0;
+}
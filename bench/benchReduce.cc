@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "dizzy.h"
+
+/* Compares the reductions against the standard algorithms, which add
+ * serially in the element type, at each SIMD level, with the error of the
+ * float sums against a double reference */
+
+namespace {
+
+const int repeats = 2000;
+
+volatile double sink;
+
+template <typename F>
+double nsPerSample(F run, size_t samples) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / samples;
+}
+
+const char *levelNames[] = {"scalar", "sse2", "avx2", "avx512"};
+
+template <typename T>
+void compare(const char *name, size_t length) {
+    std::vector<T> x(length), y(length);
+    double reference = 0.0;
+    for (size_t i = 0; i < length; i++) {
+        x[i] = 1.0 + std::sin(0.01 * i);
+        y[i] = std::cos(0.013 * i);
+        reference += (double) x[i];
+    }
+
+    double naiveSum = nsPerSample([&]() {
+        sink = std::accumulate(x.begin(), x.end(), T());
+    }, length);
+    double naiveDot = nsPerSample([&]() {
+        sink = std::inner_product(x.begin(), x.end(), y.begin(), T());
+    }, length);
+    double naiveMinMax = nsPerSample([&]() {
+        sink = *std::min_element(x.begin(), x.end()) +
+               *std::max_element(x.begin(), x.end());
+    }, length);
+    double naiveArg = nsPerSample([&]() {
+        sink = std::max_element(x.begin(), x.end()) - x.begin();
+    }, length);
+    T naive = std::accumulate(x.begin(), x.end(), T());
+    std::printf("%-6s x %7zu: naive sum %5.2f dot %5.2f minmax %5.2f "
+                "argmax %5.2f ns/sample, sum error %.2e\n", name, length,
+                naiveSum, naiveDot, naiveMinMax, naiveArg,
+                std::fabs(naive - reference) / reference);
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        double sum = nsPerSample([&]() {
+            sink = dizzy::sum(x);
+        }, length);
+        double dot = nsPerSample([&]() {
+            sink = dizzy::dot(x, y);
+        }, length);
+        double minmax = nsPerSample([&]() {
+            std::pair<T, T> range = dizzy::minmax(x);
+            sink = range.first + range.second;
+        }, length);
+        double arg = nsPerSample([&]() {
+            sink = dizzy::argmax(x);
+        }, length);
+        T total = dizzy::sum(x);
+        std::printf("%18s %-6s sum %5.2f (%.1fx) dot %5.2f (%.1fx) "
+                    "minmax %5.2f (%.1fx) argmax %5.2f (%.1fx), "
+                    "sum error %.2e\n", "", levelNames[l],
+                    sum, naiveSum / sum, dot, naiveDot / dot,
+                    minmax, naiveMinMax / minmax, arg, naiveArg / arg,
+                    std::fabs(total - reference) / reference);
+    }
+    dizzy::simd::setLevel(level);
+}
+
+}
+
+int main() {
+    size_t lengths[] = {256, 4096, 65536};
+    for (size_t length : lengths) {
+        compare<float>("float", length);
+    }
+    for (size_t length : lengths) {
+        compare<double>("double", length);
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy/resampler.h"
+
+/* Compares Resampler against cubic interpolation along a ramp of
+ * fractional indices, which is not band-limited, and a scalar polyphase
+ * loop with as many taps, for the usual rate pairs and a variable ratio */
+
+namespace {
+
+const size_t inputs = 48000;
+const int repeats = 20;
+
+volatile float sink;
+
+template <typename F>
+double nsPerSample(F run, size_t samples) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / samples;
+}
+
+/* Windowed sinc bank of phases rows, stepped through exactly */
+void naivePolyphase(std::vector<float> &y, const std::vector<float> &x,
+                    const std::vector<float> &bank, size_t taps,
+                    size_t phases, size_t stride) {
+    size_t index = 0, phase = 0;
+    for (size_t k = 0; k < y.size() && index + taps <= x.size(); k++) {
+        const float *h = bank.data() + phase * taps;
+        float sum = 0.0f;
+        for (size_t j = 0; j < taps; j++) {
+            sum += h[j] * x[index + j];
+        }
+        y[k] = sum;
+        phase += stride;
+        index += phase / phases;
+        phase %= phases;
+    }
+}
+
+void compare(double from, double to, bool variable) {
+    std::vector<float> x(inputs);
+    for (size_t i = 0; i < inputs; i++) {
+        x[i] = std::sin(0.05 * i);
+    }
+    dizzy::Resampler resampler(from, to, 64, variable);
+    std::vector<float> y(resampler.maxOutput(inputs));
+    size_t outputs = resampler.process(y, x);
+
+    /* Cubic interpolation reads a ramp of input positions */
+    std::vector<float> t(outputs), cubic(outputs);
+    double ratio = from / to;
+    double cubicTime = nsPerSample([&]() {
+        dizzy::ramp(t, 0.0f, (float) ((outputs - 1) * ratio));
+        dizzy::sampleCubic(cubic, x, t);
+        sink = cubic[0];
+    }, outputs);
+
+    size_t g = dizzy::detail::gcd((size_t) from, (size_t) to);
+    size_t phases = (size_t) to / g, stride = (size_t) from / g;
+    size_t taps = resampler.numTaps();
+    std::vector<float> bank(phases * taps);
+    for (size_t p = 0; p < phases; p++) {
+        for (size_t j = 0; j < taps; j++) {
+            bank[p * taps + j] = dizzy::detail::windowedSinc(
+                    (double) p / phases + taps / 2.0 - 1.0 - j, 0.45, taps,
+                    8.0);
+        }
+    }
+    std::vector<float> naive(outputs);
+    double naiveTime = nsPerSample([&]() {
+        naivePolyphase(naive, x, bank, taps, phases, stride);
+        sink = naive[0];
+    }, outputs);
+
+    double polyphaseTime = nsPerSample([&]() {
+        resampler.reset();
+        sink = resampler.process(y, x);
+    }, outputs);
+
+    std::printf("%6.0f -> %6.0f%s (%zu taps): cubic ramp %5.2f, naive "
+                "polyphase %5.2f, Resampler %5.2f ns/output (%.1fx naive)\n",
+                from, to, variable ? " variable" : "         ", taps,
+                cubicTime, naiveTime, polyphaseTime,
+                naiveTime / polyphaseTime);
+}
+
+}
+
+int main() {
+    double rates[][2] = {{44100, 48000}, {48000, 44100}, {48000, 96000},
+                         {96000, 48000}};
+    for (auto &rate : rates) {
+        compare(rate[0], rate[1], false);
+    }
+    compare(44100, 48000, true);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "dizzy.h"
+#include "dizzy/ring.h"
+
+/* Compares handing blocks from a producer to a consumer through a mutex
+ * protected queue of vector copies against a Ring and a BlockQueue worked
+ * on in place.  Both sides run on one thread, alternating, so the numbers
+ * are the cost of the handoff itself rather than of scheduling. */
+
+namespace {
+
+const size_t block = 256;
+const int repeats = 20000;
+
+volatile float sink;
+
+template <typename F>
+double nsPerSample(F run) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / block;
+}
+
+}
+
+int main() {
+    std::vector<float> x(block);
+    for (size_t i = 0; i < block; i++) {
+        x[i] = std::sin(0.01f * i);
+    }
+
+    /* Producer copies its block in, consumer copies it out, then scales */
+    std::mutex mutex;
+    std::deque<std::vector<float> > queue;
+    std::vector<float> y(block);
+    double locked = nsPerSample([&]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(x);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            y = queue.front();
+            queue.pop_front();
+        }
+        dizzy::mul(y, y, 0.5f);
+        sink = y[0];
+    });
+
+    /* Producer writes into the ring, consumer scales the ring in place.
+     * A ring of three blocks makes regions wrap every few rounds. */
+    dizzy::Ring ring(3 * block);
+    double ringed = nsPerSample([&]() {
+        ring.write(x);
+        dizzy::Ring::Region ready = ring.readable();
+        dizzy::mul(ready.first, ready.first, 0.5f);
+        dizzy::mul(ready.second, ready.second, 0.5f);
+        sink = ready.first.empty() ? ready.second[0] : ready.first[0];
+        ring.commitRead(ready.size());
+    });
+
+    dizzy::BlockQueue blocks(block, 4);
+    double queued = nsPerSample([&]() {
+        dizzy::BlockQueue::Block in = blocks.claimWrite();
+        std::copy(x.begin(), x.end(), in.span.begin());
+        blocks.publish(in, block);
+        dizzy::BlockQueue::Block out = blocks.claimRead();
+        dizzy::mul(out.span, out.span, 0.5f);
+        sink = out.span[0];
+        blocks.release(out);
+    });
+
+    std::printf("mutex and vector copy %6.3f ns/sample\n", locked);
+    std::printf("Ring in place         %6.3f ns/sample (%.1fx)\n", ringed,
+                locked / ringed);
+    std::printf("BlockQueue in place   %6.3f ns/sample (%.1fx)\n", queued,
+                locked / queued);
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "dizzy.h"
+
+/* Compares clamp, sign, floor, ceil, round and fract against the branching
+ * and libm loops they replaced, on random input whose branches cannot be
+ * predicted */
+
+namespace {
+
+const size_t length = 4096;
+const int repeats = 5000;
+
+volatile float sink;
+
+template <typename F>
+double nsPerSample(F run) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / length;
+}
+
+template <typename Naive, typename Dizzy>
+void compare(const char *name, Naive naive, Dizzy dizzy) {
+    double before = nsPerSample(naive);
+    double after = nsPerSample(dizzy);
+    std::printf("%-6s branching %6.3f ns/sample, dizzy %6.3f (%.1fx)\n",
+                name, before, after, before / after);
+}
+
+}
+
+int main() {
+    std::vector<float> x(length), y(length);
+    dizzy::Random random(1);
+    random.fill(x, -2.0f, 2.0f);
+    for (size_t i = 0; i < length; i += 7) {
+        x[i] = i % 2 ? 0.0f : -0.0f;
+    }
+
+    compare("clamp", [&]() {
+        for (size_t i = 0; i < length; i++) {
+            if (x[i] >= 1.0f) {
+                y[i] = 1.0f;
+            }
+            else if (x[i] <= -1.0f) {
+                y[i] = -1.0f;
+            }
+            else {
+                y[i] = x[i];
+            }
+        }
+        sink = y[1];
+    }, [&]() {
+        dizzy::clamp(y, x, -1.0f, 1.0f);
+        sink = y[1];
+    });
+
+    compare("sign", [&]() {
+        for (size_t i = 0; i < length; i++) {
+            if (x[i] > 0.0f) {
+                y[i] = 1.0f;
+            }
+            else if (x[i] < 0.0f) {
+                y[i] = -1.0f;
+            }
+            else if (1.0f / x[i] == std::numeric_limits<float>::infinity()) {
+                y[i] = 1.0f;
+            }
+            else {
+                y[i] = -1.0f;
+            }
+        }
+        sink = y[1];
+    }, [&]() {
+        dizzy::sign(y, x);
+        sink = y[1];
+    });
+
+    compare("floor", [&]() {
+        for (size_t i = 0; i < length; i++) {
+            y[i] = std::floor(x[i]);
+        }
+        sink = y[1];
+    }, [&]() {
+        dizzy::floor(y, x);
+        sink = y[1];
+    });
+
+    compare("ceil", [&]() {
+        for (size_t i = 0; i < length; i++) {
+            y[i] = std::ceil(x[i]);
+        }
+        sink = y[1];
+    }, [&]() {
+        dizzy::ceil(y, x);
+        sink = y[1];
+    });
+
+    compare("round", [&]() {
+        for (size_t i = 0; i < length; i++) {
+            y[i] = std::round(x[i]);
+        }
+        sink = y[1];
+    }, [&]() {
+        dizzy::round(y, x);
+        sink = y[1];
+    });
+
+    compare("fract", [&]() {
+        for (size_t i = 0; i < length; i++) {
+            y[i] = x[i] - std::floor(x[i]);
+        }
+        sink = y[1];
+    }, [&]() {
+        dizzy::fract(y, x);
+        sink = y[1];
+    });
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy/stft.h"
+
+/* Compares an STFT pass through with the usual hand written loop, which
+ * allocates each frame's buffers and computes its window as it goes */
+
+namespace {
+
+const size_t frameSize = 1024;
+const size_t hop = 256;
+const size_t block = 4096;
+const int repeats = 200;
+
+volatile float sink;
+
+template <typename F>
+double nsPerSample(F run) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / block;
+}
+
+}
+
+int main() {
+    std::vector<float> x(block), y(block);
+    dizzy::Random random(1);
+    random.fill(x, -1.0f, 1.0f);
+    size_t bins = frameSize / 2 + 1;
+
+    /* Frames over a history buffer, overlap-added into an output buffer,
+     * with a vector per frame for the window, frame and spectrum */
+    dizzy::FFT fft(frameSize);
+    std::vector<float> history(frameSize + block), output(frameSize + block);
+    double byHand = nsPerSample([&]() {
+        std::copy(history.end() - frameSize, history.end(), history.begin());
+        std::copy(x.begin(), x.end(), history.begin() + frameSize);
+        std::copy(output.end() - frameSize, output.end(), output.begin());
+        std::fill(output.begin() + frameSize, output.end(), 0.0f);
+        for (size_t start = 0; start < block; start += hop) {
+            std::vector<float> window(frameSize), frame(frameSize);
+            dizzy::ramp(window, 0.0f,
+                        2.0f * M_PI * (frameSize - 1) / frameSize);
+            dizzy::cos(window, window);
+            dizzy::mul(window, window, -0.5f);
+            dizzy::add(window, window, 0.5f);
+            for (size_t i = 0; i < frameSize; i++) {
+                frame[i] = history[start + i] * window[i];
+            }
+            std::vector<float> re(bins), im(bins);
+            fft.forward(re, im, frame);
+            dizzy::mul(re, re, 0.5f);
+            dizzy::mul(im, im, 0.5f);
+            fft.inverse(frame, re, im);
+            for (size_t i = 0; i < frameSize; i++) {
+                output[start + i] += frame[i] * window[i] * (2.0f / 3);
+            }
+        }
+        std::copy(output.begin(), output.begin() + block, y.begin());
+        sink = y[0];
+    });
+
+    dizzy::STFT stft(frameSize, hop, [](dizzy::Span re, dizzy::Span im) {
+        dizzy::mul(re, re, 0.5f);
+        dizzy::mul(im, im, 0.5f);
+    });
+    double streamed = nsPerSample([&]() {
+        stft.process(y, x);
+        sink = y[0];
+    });
+
+    std::printf("%zu point frames, hop %zu: by hand %6.2f ns/sample, STFT "
+                "%6.2f (%.2fx)\n", frameSize, hop, byHand, streamed,
+                byHand / streamed);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy.h"
+
+/* Compares the sampleLinear and sampleCubic gather kernels at each SIMD
+ * level against the generic per-sample loop, which strided spans still
+ * take, for clamped lookups and for wrapped lookups into tables with and
+ * without a power of two size */
+
+namespace {
+
+const size_t samples = 4096;
+const int repeats = 2000;
+
+template <typename F>
+double nsPerSample(F run) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / samples;
+}
+
+const char *levelNames[] = {"scalar", "sse2", "avx2", "avx512"};
+
+void compare(const char *name, size_t size, bool repeat, bool cubic) {
+    std::vector<float> table(size), t(samples), y(samples);
+    for (size_t i = 0; i < size; i++) {
+        table[i] = std::sin(2.0f * 3.14159265f * i / size);
+    }
+    /* A few cycles of a detuned phase, running outside the table when
+     * clamped */
+    for (size_t i = 0; i < samples; i++) {
+        t[i] = (repeat ? 0.0f : -0.1f * size) + i * 3.17f;
+    }
+
+    dizzy::StridedSpan tableSpan(table.data(), size, 1);
+    dizzy::StridedSpan tSpan(t.data(), samples, 1);
+    dizzy::StridedSpan ySpan(y.data(), samples, 1);
+    double reference = nsPerSample([&]() {
+        if (cubic) {
+            dizzy::sampleCubic(ySpan, tableSpan, tSpan, repeat);
+        }
+        else {
+            dizzy::sampleLinear(ySpan, tableSpan, tSpan, repeat);
+        }
+    });
+    std::printf("%-24s generic %6.2f ns/sample", name, reference);
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        double kernel = nsPerSample([&]() {
+            if (cubic) {
+                dizzy::sampleCubic(y, table, t, repeat);
+            }
+            else {
+                dizzy::sampleLinear(y, table, t, repeat);
+            }
+        });
+        std::printf(", %s %6.2f (%.1fx)", levelNames[l], kernel,
+                    reference / kernel);
+    }
+    dizzy::simd::setLevel(level);
+    std::printf("\n");
+}
+
+}
+
+int main() {
+    compare("linear clamp", 2000, false, false);
+    compare("linear repeat", 2000, true, false);
+    compare("linear repeat pow2", 2048, true, false);
+    compare("cubic clamp", 2000, false, true);
+    compare("cubic repeat", 2000, true, true);
+    compare("cubic repeat pow2", 2048, true, true);
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "dizzy/window.h"
+
+/* Compares windowing a frame with coefficients computed per frame by ramp
+ * and cos, then a mul, against a cached Window table applied as the frame
+ * is copied */
+
+namespace {
+
+const size_t frameSize = 1024;
+const int repeats = 20000;
+
+volatile float sink;
+
+template <typename F>
+double nsPerSample(F run) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        run();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats / frameSize;
+}
+
+}
+
+int main() {
+    std::vector<float> x(frameSize), frame(frameSize), w(frameSize);
+    dizzy::Random random(1);
+    random.fill(x, -1.0f, 1.0f);
+
+    double computed = nsPerSample([&]() {
+        dizzy::ramp(w, 0.0f, 2.0f * M_PI * (frameSize - 1) / frameSize);
+        dizzy::cos(w, w);
+        dizzy::mul(w, w, -0.5f);
+        dizzy::add(w, w, 0.5f);
+        dizzy::mul(frame, x, w);
+        sink = frame[1];
+    });
+
+    double cached = nsPerSample([&]() {
+        std::shared_ptr<const dizzy::Window> hann =
+                dizzy::Window::get(dizzy::Window::HANN, frameSize);
+        hann->apply(frame, x);
+        sink = frame[1];
+    });
+
+    std::printf("%zu point Hann: ramp and cos per frame %6.3f ns/sample, "
+                "cached Window %6.3f (%.1fx)\n", frameSize, computed, cached,
+                computed / cached);
+    return 0;
+}
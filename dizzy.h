@@ -3,16 +3,202 @@
 
 #include <array>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dizzy/simd.h"
+#include "dizzy/span.h"
 
 namespace dizzy {
 
+namespace detail {
+
+/* Element type of a container, which the scalar arguments and results of
+ * the functions below take */
+template <typename T>
+using Value = typename std::remove_const<typename T::value_type>::type;
+
+/* Containers of float, which the float kernels take directly when they are
+ * contiguous and through a buffer on the stack otherwise */
+template <typename T>
+struct Floats {
+    static const bool value = std::is_same<Value<T>, float>::value;
+};
+
+/* Containers which store their elements of type F contiguously, and so can
+ * be handed straight to the SIMD kernels for F */
+template <typename T, typename F=float>
+struct Contiguous {
+    static const bool value = false;
+
+    static F *data(T &) { return NULL; }
+    static const F *data(const T &) { return NULL; }
+};
+
+template <typename F, size_t N>
+struct Contiguous<std::array<F, N>, F> {
+    static const bool value = true;
+
+    static F *data(std::array<F, N> &x) { return x.data(); }
+    static const F *data(const std::array<F, N> &x) { return x.data(); }
+};
+
+template <typename F, typename A>
+struct Contiguous<std::vector<F, A>, F> {
+    static const bool value = true;
+
+    static F *data(std::vector<F, A> &x) { return x.data(); }
+    static const F *data(const std::vector<F, A> &x) { return x.data(); }
+};
+
+template <typename F>
+struct Contiguous<BasicSpan<F>, F> {
+    static const bool value = true;
+
+    static F *data(const BasicSpan<F> &x) { return x.data(); }
+};
+
+template <typename T>
+float *data(T &x) {
+    return Contiguous<T>::data(x);
+}
+
+template <typename T>
+const float *data(const T &x) {
+    return Contiguous<T>::data(x);
+}
+
+/* Double containers take the double kernels where there are any, and the
+ * generic loops otherwise */
+template <typename T>
+double *doubles(T &x) {
+    return Contiguous<T, double>::data(x);
+}
+
+template <typename T>
+const double *doubles(const T &x) {
+    return Contiguous<T, double>::data(x);
+}
+
+/* Elementwise kernels for T.  A std::array's size is known at compile
+ * time, so it gets kernels compiled for that length; since every argument
+ * has the same type, sizes which differ do not compile at all. */
+template <typename T>
+struct Dispatch {
+    static simd::Kernels &kernels() { return simd::kernels(); }
+};
+
+template <size_t N>
+struct Dispatch<std::array<float, N> > {
+    static const simd::FixedKernels<N> &kernels() {
+        return simd::fixedKernels<N>();
+    }
+};
+
+template <size_t N>
+struct Dispatch<std::array<double, N> > {
+    static const simd::FixedKernels<N> &kernels() {
+        return simd::fixedKernels<N>();
+    }
+};
+
+template <typename T>
+auto kernels() -> decltype(Dispatch<T>::kernels()) {
+    return Dispatch<T>::kernels();
+}
+
+/* Run a contiguous kernel over any container.  Containers which are not
+ * contiguous are staged through a small buffer on the stack. */
+template <typename T>
+void unary(void (*kernel)(float *, const float *, size_t),
+           T &dst, const T &x, size_t length) {
+    if (Contiguous<T>::value) {
+        kernel(data(dst), data(x), length);
+        return;
+    }
+
+    float buffer[64];
+    auto dstIt = dst.begin();
+    auto xIt = x.begin();
+    for (size_t i = 0; i < length; i += 64) {
+        size_t n = std::min(length - i, (size_t) 64);
+        std::copy(xIt, xIt + n, buffer);
+        kernel(buffer, buffer, n);
+        std::copy(buffer, buffer + n, dstIt);
+        xIt += n;
+        dstIt += n;
+    }
+}
+
+template <typename T>
+void binary(void (*kernel)(float *, const float *, float, size_t),
+            T &dst, const T &x, float y, size_t length) {
+    if (Contiguous<T>::value) {
+        kernel(data(dst), data(x), y, length);
+        return;
+    }
+
+    float buffer[64];
+    auto dstIt = dst.begin();
+    auto xIt = x.begin();
+    for (size_t i = 0; i < length; i += 64) {
+        size_t n = std::min(length - i, (size_t) 64);
+        std::copy(xIt, xIt + n, buffer);
+        kernel(buffer, buffer, y, n);
+        std::copy(buffer, buffer + n, dstIt);
+        xIt += n;
+        dstIt += n;
+    }
+}
+
 template <typename T>
-void add(T &dst, const T &x, float y) {
+void binary(void (*kernel)(float *, const float *, const float *, size_t),
+            T &dst, const T &x, const T &y, size_t length) {
+    if (Contiguous<T>::value) {
+        kernel(data(dst), data(x), data(y), length);
+        return;
+    }
+
+    float xBuffer[64], yBuffer[64];
+    auto dstIt = dst.begin();
+    auto xIt = x.begin();
+    auto yIt = y.begin();
+    for (size_t i = 0; i < length; i += 64) {
+        size_t n = std::min(length - i, (size_t) 64);
+        std::copy(xIt, xIt + n, xBuffer);
+        std::copy(yIt, yIt + n, yBuffer);
+        kernel(xBuffer, xBuffer, yBuffer, n);
+        std::copy(xBuffer, xBuffer + n, dstIt);
+        xIt += n;
+        yIt += n;
+        dstIt += n;
+    }
+}
+
+}
+
+template <typename T>
+void add(T &dst, const T &x, detail::Value<T> y) {
     size_t length = std::min(dst.size(), x.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().addVS(detail::data(dst), detail::data(x), y,
+                                   length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.addVS(detail::doubles(dst),
+                                           detail::doubles(x), y, length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto dstEnd = dstIt + length;
@@ -27,6 +213,18 @@ void add(T &dst, const T &x,
     size_t length = std::min(dst.size(), x.size());
     length = std::min(length, y.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().addVV(detail::data(dst), detail::data(x),
+                                   detail::data(y), length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.addVV(detail::doubles(dst),
+                                           detail::doubles(x),
+                                           detail::doubles(y), length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto yIt = y.begin();
@@ -37,9 +235,20 @@ void add(T &dst, const T &x,
 }
 
 template <typename T>
-void sub(T &dst, const T &x, float y) {
+void sub(T &dst, const T &x, detail::Value<T> y) {
     size_t length = std::min(dst.size(), x.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().subVS(detail::data(dst), detail::data(x), y,
+                                   length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.subVS(detail::doubles(dst),
+                                           detail::doubles(x), y, length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto dstEnd = dstIt + length;
@@ -53,6 +262,18 @@ void sub(T &dst, const T &x, const T &y) {
     size_t length = std::min(dst.size(), x.size());
     length = std::min(length, y.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().subVV(detail::data(dst), detail::data(x),
+                                   detail::data(y), length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.subVV(detail::doubles(dst),
+                                           detail::doubles(x),
+                                           detail::doubles(y), length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto yIt = y.begin();
@@ -63,9 +284,20 @@ void sub(T &dst, const T &x, const T &y) {
 }
 
 template <typename T>
-void mul(T &dst, const T &x, float y) {
+void mul(T &dst, const T &x, detail::Value<T> y) {
     size_t length = std::min(dst.size(), x.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().mulVS(detail::data(dst), detail::data(x), y,
+                                   length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.mulVS(detail::doubles(dst),
+                                           detail::doubles(x), y, length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto dstEnd = dstIt + length;
@@ -79,6 +311,18 @@ void mul(T &dst, const T &x, const T &y) {
     size_t length = std::min(dst.size(), x.size());
     length = std::min(length, y.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().mulVV(detail::data(dst), detail::data(x),
+                                   detail::data(y), length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.mulVV(detail::doubles(dst),
+                                           detail::doubles(x),
+                                           detail::doubles(y), length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto yIt = y.begin();
@@ -91,7 +335,7 @@ void mul(T &dst, const T &x, const T &y) {
 template <typename T>
 void mulCplx(T &dstReal, T &dstImag,
              const T &xReal, const T &xImag,
-             float yReal, float yImag) {
+             detail::Value<T> yReal, detail::Value<T> yImag) {
     size_t length = std::min(dstReal.size(), dstImag.size());
     length = std::min(length, xReal.size());
     length = std::min(length, xImag.size());
@@ -116,6 +360,14 @@ void mulCplx(T &dstReal, T &dstImag,
     length = std::min(length, yReal.size());
     length = std::min(length, yImag.size());
 
+    if (detail::Contiguous<T>::value) {
+        simd::kernels().mulCplx(detail::data(dstReal), detail::data(dstImag),
+                                detail::data(xReal), detail::data(xImag),
+                                detail::data(yReal), detail::data(yImag),
+                                length);
+        return;
+    }
+
     auto dstRealIt = dstReal.begin(), dstImagIt = dstImag.begin();
     auto xRealIt = xReal.begin(), xImagIt = xImag.begin();
     auto yRealIt = yReal.begin(), yImagIt = yImag.begin();
@@ -128,9 +380,20 @@ void mulCplx(T &dstReal, T &dstImag,
 }
 
 template <typename T>
-void div(T &dst, const T &x, float y) {
+void div(T &dst, const T &x, detail::Value<T> y) {
     size_t length = std::min(dst.size(), x.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().divVS(detail::data(dst), detail::data(x), y,
+                                   length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.divVS(detail::doubles(dst),
+                                           detail::doubles(x), y, length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto dstEnd = dstIt + length;
@@ -144,6 +407,18 @@ void div(T &dst, const T &x, const T &y) {
     size_t length = std::min(dst.size(), x.size());
     length = std::min(length, y.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().divVV(detail::data(dst), detail::data(x),
+                                   detail::data(y), length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.divVV(detail::doubles(dst),
+                                           detail::doubles(x),
+                                           detail::doubles(y), length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto yIt = y.begin();
@@ -156,12 +431,12 @@ void div(T &dst, const T &x, const T &y) {
 template <typename T>
 void divCplx(T &dstReal, T &dstImag,
              const T &xReal, const T &xImag,
-             float yReal, float yImag) {
+             detail::Value<T> yReal, detail::Value<T> yImag) {
     size_t length = std::min(dstReal.size(), dstImag.size());
     length = std::min(length, xReal.size());
     length = std::min(length, xImag.size());
 
-    float denom = yReal * yReal + yImag * yImag;
+    detail::Value<T> denom = yReal * yReal + yImag * yImag;
 
     auto dstRealIt = dstReal.begin(), dstImagIt = dstImag.begin();
     auto xRealIt = xReal.begin(), xImagIt = xImag.begin();
@@ -189,17 +464,30 @@ void divCplx(T &dstReal, T &dstImag,
     auto dstEnd = dstRealIt + length;
     for (; dstRealIt != dstEnd;
          dstRealIt++, dstImagIt++, xRealIt++, xImagIt++, yRealIt++, yImagIt++) {
-        float denom = (*yRealIt) * (*yRealIt) + (*yImagIt) * (*yImagIt);
+        detail::Value<T> denom = (*yRealIt) * (*yRealIt) +
+                                 (*yImagIt) * (*yImagIt);
         *dstRealIt = ((*xRealIt) * (*yRealIt) + (*xImagIt) * (*yImagIt)) / denom;
         *dstImagIt = ((*xImagIt) * (*yRealIt) - (*xRealIt) * (*yImagIt)) / denom;   
     }
 }
 
 template <typename T>
-void madd(T &dst, const T &x, const T &y, float z) {
+void madd(T &dst, const T &x, const T &y, detail::Value<T> z) {
     size_t length = std::min(dst.size(), x.size());
     length = std::min(length, y.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().maddVVS(detail::data(dst), detail::data(x),
+                                     detail::data(y), z, length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.maddVVS(detail::doubles(dst),
+                                             detail::doubles(x),
+                                             detail::doubles(y), z, length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto yIt = y.begin();
@@ -217,6 +505,19 @@ void madd(T &dst, const T &x, const T &y,
     length = std::min(length, y.size());
     length = std::min(length, z.size());
 
+    if (detail::Contiguous<T>::value) {
+        detail::kernels<T>().maddVVV(detail::data(dst), detail::data(x),
+                                     detail::data(y), detail::data(z), length);
+        return;
+    }
+    if (detail::Contiguous<T, double>::value) {
+        detail::kernels<T>().doubles.maddVVV(detail::doubles(dst),
+                                             detail::doubles(x),
+                                             detail::doubles(y),
+                                             detail::doubles(z), length);
+        return;
+    }
+
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto yIt = y.begin();
@@ -227,6 +528,43 @@ void madd(T &dst, const T &x, const T &y,
     }
 }
 
+/* Complex multiply-accumulate, dst = x + y * z, e.g. for summing spectral
+ * products in place with dst and x the same */
+template <typename T>
+void maddCplx(T &dstReal, T &dstImag,
+              const T &xReal, const T &xImag,
+              const T &yReal, const T &yImag,
+              const T &zReal, const T &zImag) {
+    size_t length = std::min(dstReal.size(), dstImag.size());
+    length = std::min(length, std::min(xReal.size(), xImag.size()));
+    length = std::min(length, std::min(yReal.size(), yImag.size()));
+    length = std::min(length, std::min(zReal.size(), zImag.size()));
+
+    if (detail::Contiguous<T>::value) {
+        simd::kernels().maddCplx(detail::data(dstReal), detail::data(dstImag),
+                                 detail::data(xReal), detail::data(xImag),
+                                 detail::data(yReal), detail::data(yImag),
+                                 detail::data(zReal), detail::data(zImag),
+                                 length);
+        return;
+    }
+
+    auto dstRealIt = dstReal.begin(), dstImagIt = dstImag.begin();
+    auto xRealIt = xReal.begin(), xImagIt = xImag.begin();
+    auto yRealIt = yReal.begin(), yImagIt = yImag.begin();
+    auto zRealIt = zReal.begin(), zImagIt = zImag.begin();
+    auto dstEnd = dstRealIt + length;
+    for (; dstRealIt != dstEnd; dstRealIt++, dstImagIt++, xRealIt++,
+         xImagIt++, yRealIt++, yImagIt++, zRealIt++, zImagIt++) {
+        detail::Value<T> re = (*yRealIt) * (*zRealIt) -
+                              (*yImagIt) * (*zImagIt);
+        detail::Value<T> im = (*yRealIt) * (*zImagIt) +
+                              (*yImagIt) * (*zRealIt);
+        *dstRealIt = (*xRealIt) + re;
+        *dstImagIt = (*xImagIt) + im;
+    }
+}
+
 template <typename T>
 void abs(T &dst, const T &x) {
     size_t length = std::min(dst.size(), x.size());
@@ -329,19 +667,24 @@ void atan(T &dst, const T &x) {
 template <typename T>
 void atan2(T &dst, const T &y, const T &x) {
     size_t length = std::min(dst.size(), x.size());
+    length = std::min(length, y.size());
 
     auto dstIt = dst.begin();
     auto xIt = x.begin();
-    auto yIt = x.begin();
+    auto yIt = y.begin();
     auto dstEnd = dstIt + length;
     for (; dstIt != dstEnd; dstIt++, xIt++, yIt++) {
-        *dstIt = std::atan(*yIt, *xIt);
+        *dstIt = std::atan2(*yIt, *xIt);
     }
 }
 
 template <typename T>
-void ceil(T &dst, const T &x) {   
+void ceil(T &dst, const T &x) {
     size_t length = std::min(dst.size(), x.size());
+    if (detail::Floats<T>::value) {
+        detail::unary(simd::kernels().ceil, dst, x, length);
+        return;
+    }
 
     auto dstIt = dst.begin();
     auto xIt = x.begin();
@@ -352,8 +695,12 @@ void ceil(T &dst, const T &x) {
 }
 
 template <typename T>
-void floor(T &dst, const T &x) {  
+void floor(T &dst, const T &x) {
     size_t length = std::min(dst.size(), x.size());
+    if (detail::Floats<T>::value) {
+        detail::unary(simd::kernels().floor, dst, x, length);
+        return;
+    }
 
     auto dstIt = dst.begin();
     auto xIt = x.begin();
@@ -366,6 +713,10 @@ void floor(T &dst, const T &x) {
 template <typename T>
 void round(T &dst, const T &x) {
     size_t length = std::min(dst.size(), x.size());
+    if (detail::Floats<T>::value) {
+        detail::unary(simd::kernels().round, dst, x, length);
+        return;
+    }
 
     auto dstIt = dst.begin();
     auto xIt = x.begin();
@@ -400,7 +751,7 @@ void log(T &dst, const T &x) {
 }
 
 template <typename T>
-void pow(T &dst, const T &x, float y) {
+void pow(T &dst, const T &x, detail::Value<T> y) {
     size_t length = std::min(dst.size(), x.size());
 
     auto dstIt = dst.begin();
@@ -439,56 +790,315 @@ void sqrt(T &dst, const T &x) {
     }
 }
 
+namespace detail {
+
+/* Identities of min and max */
+template <typename F>
+F highest() {
+    return std::numeric_limits<F>::has_infinity ?
+           std::numeric_limits<F>::infinity() :
+           std::numeric_limits<F>::max();
+}
+
+template <typename F>
+F lowest() {
+    return std::numeric_limits<F>::has_infinity ?
+           -std::numeric_limits<F>::infinity() :
+           std::numeric_limits<F>::lowest();
+}
+
+/* Kahan compensated running sum */
+template <typename F>
+struct Kahan {
+    Kahan() : s(), c() {}
+
+    void add(F v) {
+        F y = v - c;
+        F t = s + y;
+        c = (t - s) - y;
+        s = t;
+    }
+
+    F s;
+    F c;
+};
+
+/* Index of the first smallest, or with Max largest, element */
+template <bool Max, typename T>
+size_t extreme(const T &x) {
+    typedef Value<T> F;
+    size_t length = x.size();
+    if (Contiguous<T>::value) {
+        simd::Kernels &kernels = simd::kernels();
+        return (Max ? kernels.argmax : kernels.argmin)(data(x), length);
+    }
+    if (Contiguous<T, double>::value) {
+        simd::DoubleKernels &kernels = simd::kernels().doubles;
+        return (Max ? kernels.argmax : kernels.argmin)(doubles(x), length);
+    }
+
+    F best = Max ? lowest<F>() : highest<F>();
+    size_t index = length;
+    size_t i = 0;
+    for (auto xIt = x.begin(); i < length; xIt++, i++) {
+        bool better = Max ? *xIt > best : *xIt < best;
+        if (better || (index == length && *xIt == best)) {
+            best = *xIt;
+            index = i;
+        }
+    }
+    return index;
+}
+
+}
+
+/* Smallest and largest elements in one pass.  NaNs are skipped, and empty
+ * or all NaN input gives +inf and -inf (the type's limits for integers), so
+ * the results for separate blocks combine with std::min and std::max. */
+template <typename T>
+std::pair<detail::Value<T>, detail::Value<T> > minmax(const T &x) {
+    typedef detail::Value<T> F;
+    size_t length = x.size();
+
+    if (detail::Contiguous<T>::value) {
+        float lo, hi;
+        simd::kernels().minmax(&lo, &hi, detail::data(x), length);
+        return std::make_pair(F(lo), F(hi));
+    }
+    if (detail::Contiguous<T, double>::value) {
+        double lo, hi;
+        simd::kernels().doubles.minmax(&lo, &hi, detail::doubles(x), length);
+        return std::make_pair(F(lo), F(hi));
+    }
+
+    F lo = detail::highest<F>(), hi = detail::lowest<F>();
+    auto xIt = x.begin();
+    auto xEnd = xIt + length;
+    for (; xIt != xEnd; xIt++) {
+        lo = *xIt < lo ? *xIt : lo;
+        hi = *xIt > hi ? *xIt : hi;
+    }
+    return std::make_pair(lo, hi);
+}
+
 template <typename T>
-float max(const T &x) {
-    return *std::max_element(x.begin(), x.end());
+detail::Value<T> max(const T &x) {
+    return minmax(x).second;
 }
 
 template <typename T>
-float min(const T &x) {
-    return *std::min_element(x.begin(), x.end());
+detail::Value<T> min(const T &x) {
+    return minmax(x).first;
 }
 
+/* Index of the first smallest or largest element, or size() if there is
+ * none, with NaNs skipped */
 template <typename T>
-float sum(const T &x) {
-    float s = std::accumulate(x.begin(), x.end(), 0.0f);
-    return s;
+size_t argmin(const T &x) {
+    return detail::extreme<false>(x);
 }
 
 template <typename T>
-void random(T &dst, float low = 0.0f, float high = 1.0f) {
-    float diff = high - low;
+size_t argmax(const T &x) {
+    return detail::extreme<true>(x);
+}
 
-    auto dstIt = dst.begin();
-    auto dstEnd = dst.end();
-    for (; dstIt != dstEnd; dstIt++) {
-        *dstIt = ((float) std::rand() / RAND_MAX) * diff + low;
+/* Sum of x.  Contiguous floats are summed in blocks in several SIMD
+ * accumulators, with the block totals added in double, and contiguous
+ * doubles in SIMD lanes with Kahan compensation.  Other containers are
+ * summed serially with Kahan compensation. */
+template <typename T>
+detail::Value<T> sum(const T &x) {
+    size_t length = x.size();
+    if (detail::Contiguous<T>::value) {
+        return simd::kernels().sum(detail::data(x), length);
+    }
+    if (detail::Contiguous<T, double>::value) {
+        return simd::kernels().doubles.sum(detail::doubles(x), length);
+    }
+
+    detail::Kahan<detail::Value<T> > s;
+    auto xIt = x.begin();
+    auto xEnd = xIt + length;
+    for (; xIt != xEnd; xIt++) {
+        s.add(*xIt);
+    }
+    return s.s;
+}
+
+/* Sum of x[i] * y[i], as accurate as sum() */
+template <typename T>
+detail::Value<T> dot(const T &x, const T &y) {
+    size_t length = std::min(x.size(), y.size());
+    if (detail::Contiguous<T>::value) {
+        return simd::kernels().dot(detail::data(x), detail::data(y), length);
+    }
+    if (detail::Contiguous<T, double>::value) {
+        return simd::kernels().doubles.dot(detail::doubles(x),
+                                           detail::doubles(y), length);
+    }
+
+    detail::Kahan<detail::Value<T> > s;
+    auto xIt = x.begin();
+    auto yIt = y.begin();
+    auto xEnd = xIt + length;
+    for (; xIt != xEnd; xIt++, yIt++) {
+        s.add((*xIt) * (*yIt));
+    }
+    return s.s;
+}
+
+template <typename T>
+detail::Value<T> sumOfSquares(const T &x) {
+    return dot(x, x);
+}
+
+/* Root mean square, or 0 for empty input */
+template <typename T>
+detail::Value<T> rms(const T &x) {
+    if (x.size() == 0) {
+        return detail::Value<T>();
+    }
+    return std::sqrt(sumOfSquares(x) / x.size());
+}
+
+/* Uniform random number stream with its own state, so that separate
+ * streams can be used from separate threads without locking.  The same
+ * seed and stream number always give the same sequence, on every SIMD
+ * level up to the rounding of the scaling, whatever the buffer sizes it is
+ * drawn in.  Different stream numbers give independent sequences, e.g. one
+ * per channel.
+ *
+ * Internally it runs 16 interleaved xoshiro128+ generators, so buffers are
+ * filled 4, 8 or 16 samples at a time.  Samples have 24 bits of
+ * resolution.  Not suitable for cryptography. */
+class Random {
+public:
+    explicit Random(uint64_t seed=0, uint64_t stream=0) {
+        this->seed(seed, stream);
+    }
+
+    void seed(uint64_t seed, uint64_t stream=0) {
+        /* Expand the seed with splitmix64, which never gives an all zero
+         * state for a generator */
+        uint64_t x = seed ^ (stream * 0xd1342543de82ef95ull);
+        for (size_t i = 0; i < 2 * simd::randomLanes; i++) {
+            x += 0x9e3779b97f4a7c15ull;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            z ^= z >> 31;
+            state[2 * i] = (int32_t) (uint32_t) z;
+            state[2 * i + 1] = (int32_t) (uint32_t) (z >> 32);
+        }
+        position = simd::randomLanes;
+    }
+
+    /* Fill dst with samples in [low, high).  Other element types than
+     * float are scaled in their own precision from the same samples. */
+    template <typename T>
+    void fill(T &dst, detail::Value<T> low=0, detail::Value<T> high=1) {
+        size_t length = dst.size();
+        if (detail::Contiguous<T>::value) {
+            generate(detail::data(dst), length, low, high);
+            return;
+        }
+
+        bool scaled = !std::is_same<detail::Value<T>, float>::value;
+        float buffer[64];
+        auto dstIt = dst.begin();
+        for (size_t i = 0; i < length; i += 64) {
+            size_t n = std::min(length - i, (size_t) 64);
+            if (!scaled) {
+                generate(buffer, n, low, high);
+                dstIt = std::copy(buffer, buffer + n, dstIt);
+                continue;
+            }
+
+            generate(buffer, n, 0.0f, 1.0f);
+            for (size_t j = 0; j < n; j++, dstIt++) {
+                *dstIt = low + buffer[j] * (high - low);
+            }
+        }
+    }
+
+    /* A single sample in [0, 1) */
+    float next() {
+        float x;
+        generate(&x, 1, 0.0f, 1.0f);
+        return x;
+    }
+
+private:
+    void generate(float *dst, size_t length, float low, float high) {
+        size_t lanes = simd::randomLanes;
+        size_t i = 0;
+        for (; i < length && position < lanes; i++, position++) {
+            dst[i] = low + cache[position] * (high - low);
+        }
+
+        size_t blocks = (length - i) / lanes;
+        simd::kernels().random(dst + i, state, blocks, low, high);
+        i += blocks * lanes;
+
+        if (i < length) {
+            simd::kernels().random(cache, state, 1, 0.0f, 1.0f);
+            position = 0;
+            for (; i < length; i++, position++) {
+                dst[i] = low + cache[position] * (high - low);
+            }
+        }
     }
+
+    int32_t state[4 * simd::randomLanes];
+    float cache[simd::randomLanes];
+    size_t position;
+};
+
+namespace detail {
+
+/* Stream used by random(), one per thread */
+inline Random &threadRandom() {
+    static std::atomic<uint64_t> streams(0);
+    static thread_local Random random(0x5eed, streams++);
+    return random;
+}
+
 }
 
 template <typename T>
-void clamp(T &dst, const T &x, float xMin, float xMax) {
+void random(T &dst, detail::Value<T> low = 0, detail::Value<T> high = 1) {
+    detail::threadRandom().fill(dst, low, high);
+}
+
+template <typename T>
+void clamp(T &dst, const T &x, detail::Value<T> xMin,
+           detail::Value<T> xMax) {
     size_t length = std::min(dst.size(), x.size());
+    auto kernel = simd::kernels().clamp;
+    if (detail::Contiguous<T>::value && kernel) {
+        kernel(detail::data(dst), detail::data(x), xMin, xMax, length);
+        return;
+    }
 
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto dstEnd = dstIt + length;
     for (; dstIt != dstEnd; dstIt++, xIt++) {
-        if (*xIt >= xMax) {
-            *dstIt = xMax;
-        }
-        else if (*xIt <= xMin) {
-            *dstIt = xMin;
-        }
-        else {
-            *dstIt = *xIt;
-        }
+        /* Two selects the compiler can make branchless */
+        detail::Value<T> v = *xIt;
+        detail::Value<T> r = v <= xMin ? xMin : v;
+        *dstIt = v >= xMax ? xMax : r;
     }
 }
 
 template <typename T>
-void fract(T &dst, const T &x) {  
+void fract(T &dst, const T &x) {
     size_t length = std::min(dst.size(), x.size());
+    if (detail::Floats<T>::value) {
+        detail::unary(simd::kernels().fract, dst, x, length);
+        return;
+    }
 
     auto dstIt = dst.begin();
     auto xIt = x.begin();
@@ -499,10 +1109,10 @@ void fract(T &dst, const T &x) {
 }
 
 template <typename T>
-void ramp(T &dst, float first, float last) {
+void ramp(T &dst, detail::Value<T> first, detail::Value<T> last) {
     size_t length = dst.size();
 
-    float increment = (last - first) / (length - 1u);
+    detail::Value<T> increment = (last - first) / (length - 1u);
 
     auto dstIt = dst.begin();
     auto dstEnd = dst.end();
@@ -513,35 +1123,56 @@ void ramp(T &dst, float first, float last) {
 }
 
 template <typename T>
-void sign(T &dst, const T &x) {   
-    /* Is there a faster way to work out whether we have +0.0 or -0.0?
-     * Mainly want to get rid of the division */
+void sign(T &dst, const T &x) {
+    /* The sign bit decides, so -0.0 gives -1; so does NaN */
     size_t length = std::min(dst.size(), x.size());
+    if (detail::Floats<T>::value) {
+        detail::unary(simd::kernels().sign, dst, x, length);
+        return;
+    }
 
+    typedef detail::Value<T> F;
     auto dstIt = dst.begin();
     auto xIt = x.begin();
     auto dstEnd = dstIt + length;
     for (; dstIt != dstEnd; dstIt++, xIt++) {
-        if (*xIt > 0.0f) {
-            *dstIt = 1.0f;
-        }
-        else if (*xIt < 0.0f) {
-            *dstIt = -1.0f;
-        }
-        else if (1.0f / *xIt == std::numeric_limits<float>::infinity()) {
-            *dstIt = 1.0f;
-        }
-        else {
-            *dstIt = -1.0f;
-        }
+        *dstIt = *xIt == *xIt ? std::copysign(F(1), *xIt) : F(-1);
     }
 }
 
+namespace detail {
+
+/* Table wrapping for the sample kernels.  Power of two table sizes, which
+ * include a single entry, wrap with a mask. */
+inline simd::Wrap wrap(size_t size, bool repeat) {
+    if (!repeat) {
+        return simd::CLAMP;
+    }
+    return (size & (size - 1)) == 0 ? simd::WRAP_MASK : simd::WRAP;
+}
+
+}
+
+/* Read the table x at fractional positions t, with linear or cubic
+ * interpolation.  Positions outside the table are clamped to its ends, or
+ * with repeat wrap around it. */
 template <typename T>
 void sampleLinear(T &dst, const T &x, const T &t,
                   bool repeat=false) {
     size_t length = std::min(dst.size(), t.size());
     size_t xLength = x.size();
+    if (xLength == 0) {
+        return;
+    }
+
+    auto kernel = simd::kernels().sampleLinear[detail::wrap(xLength, repeat)];
+    if (detail::Contiguous<T>::value && kernel) {
+        kernel(detail::data(dst), detail::data(x), xLength, detail::data(t),
+               length);
+        return;
+    }
+
+    typedef detail::Value<T> F;
     uint32_t maxIndex = xLength - 1u;
 
     auto dstIt = dst.begin();
@@ -549,25 +1180,26 @@ void sampleLinear(T &dst, const T &x, const T &t,
     auto dstEnd = dstIt + length;
 
     if (repeat) {
-        float invXLength = 1.0f / xLength;
+        F invXLength = F(1) / xLength;
 
         for (; dstIt != dstEnd; dstIt++, tIt++) {
-            float tDash = *tIt - std::floor(*tIt * invXLength) * xLength;
+            F tDash = *tIt - std::floor(*tIt * invXLength) * xLength;
             uint32_t idx = tDash;
-            float w = tDash - idx;
-            float p1 = x[idx];
-            float p2 = x[idx < maxIndex ? idx + 1u : 0u];
+            F w = tDash - idx;
+            F p1 = x[idx];
+            F p2 = x[idx < maxIndex ? idx + 1u : 0u];
             *dstIt = p1 + w * (p2 - p1);
         }
     }
     else {
         for (; dstIt != dstEnd; dstIt++, tIt++) {
-            float tDash = *tIt < 0.0f ? 0.0f :
-                (*tIt > maxIndex ? maxIndex : *tIt);
+            /* Ordered so that NaN becomes 0 */
+            F tDash = *tIt > 0.0f ? (*tIt < maxIndex ? *tIt : maxIndex) :
+                0.0f;
             uint32_t idx = tDash;
-            float w = tDash - idx;
-            float p1 = x[idx];
-            float p2 = x[idx < maxIndex ? idx + 1u : maxIndex];
+            F w = tDash - idx;
+            F p1 = x[idx];
+            F p2 = x[idx < maxIndex ? idx + 1u : maxIndex];
             *dstIt = p1 + w * (p2 - p1);
         }
     }
@@ -578,6 +1210,18 @@ void sampleCubic(T &dst, const T &x, const T &t,
                  bool repeat=false)  {
     size_t length = std::min(dst.size(), t.size());
     size_t xLength = x.size();
+    if (xLength == 0) {
+        return;
+    }
+
+    auto kernel = simd::kernels().sampleCubic[detail::wrap(xLength, repeat)];
+    if (detail::Contiguous<T>::value && kernel) {
+        kernel(detail::data(dst), detail::data(x), xLength, detail::data(t),
+               length);
+        return;
+    }
+
+    typedef detail::Value<T> F;
     uint32_t maxIndex = xLength - 1u;
 
     auto dstIt = dst.begin();
@@ -585,96 +1229,161 @@ void sampleCubic(T &dst, const T &x, const T &t,
     auto dstEnd = dstIt + length;
 
     if (repeat) {
-        float invXLength = 1.0f / xLength;
+        F invXLength = F(1) / xLength;
 
         for (; dstIt != dstEnd; dstIt++, tIt++) {
-            float tDash = *tIt - std::floor(*tIt * invXLength) * xLength;
+            F tDash = *tIt - std::floor(*tIt * invXLength) * xLength;
             uint32_t idx = tDash;
-            float w = tDash - idx;
-            float w2 = w * w;
-            float w3 = w2 * w;
-            float h2 = -2.0f * w3 + 3.0f * w2;
-            float h1 = 1.0f - h2;
-            float h4 = w3 - w2;
-            float h3 = h4 - w2 + w;
-            float p1 = x[idx > 0u ? idx - 1u : maxIndex];
-            float p2 = x[idx];
-            float p3 = x[idx < maxIndex ? idx + 1u : 0u];
-            float p4 = x[idx < maxIndex - 1u ? idx + 2u :
-                            (idx + 2u - std::floor((idx + 2u) * invXLength) *
-                             xLength)];
+            F w = tDash - idx;
+            F w2 = w * w;
+            F w3 = w2 * w;
+            F h2 = -2.0f * w3 + 3.0f * w2;
+            F h1 = 1.0f - h2;
+            F h4 = w3 - w2;
+            F h3 = h4 - w2 + w;
+            F p1 = x[idx > 0u ? idx - 1u : maxIndex];
+            F p2 = x[idx];
+            F p3 = x[idx < maxIndex ? idx + 1u : 0u];
+            F p4 = x[(idx + 2u) % xLength];
             *dstIt = h1 * p2 + h2 * p3 +
                      0.5f * (h3 * (p3 - p1) + h4 * (p4 - p2));
         }
     }
     else {
         for (; dstIt != dstEnd; dstIt++, tIt++) {
-            float tDash = *tIt < 0.0f ? 0.0f :
-                *tIt > maxIndex ? maxIndex : *tIt;
+            F tDash = *tIt > 0.0f ? (*tIt < maxIndex ? *tIt : maxIndex) :
+                0.0f;
             uint32_t idx = tDash;
-            float w = tDash - idx;
-            float w2 = w * w;
-            float w3 = w2 * w;
-            float h2 = -2.0f * w3 + 3.0f * w2;
-            float h1 = 1.0f - h2;
-            float h4 = w3 - w2;
-            float h3 = h4 - w2 + w;
-            float p1 = x[idx > 0u ? idx - 1u : 0u];
-            float p2 = x[idx];
-            float p3 = x[idx < maxIndex ? idx + 1u : 0u];
-            float p4 = x[idx < maxIndex - 1u ? idx + 2u : maxIndex];
+            F w = tDash - idx;
+            F w2 = w * w;
+            F w3 = w2 * w;
+            F h2 = -2.0f * w3 + 3.0f * w2;
+            F h1 = 1.0f - h2;
+            F h4 = w3 - w2;
+            F h3 = h4 - w2 + w;
+            F p1 = x[idx > 0u ? idx - 1u : 0u];
+            F p2 = x[idx];
+            F p3 = x[idx < maxIndex ? idx + 1u : 0u];
+            F p4 = x[idx + 2u <= maxIndex ? idx + 2u : maxIndex];
             *dstIt = h1 * p2 + h2 * p3 +
                      0.5f * (h3 * (p3 - p1) + h4 * (p4 - p2));
         }
     }
 }
 
+namespace detail {
+
+/* Number of whole frames of channels in size floats, with the first at
+ * offset and one every stride */
+inline size_t frames(size_t size, uint32_t offset, uint32_t stride,
+                     size_t channels) {
+    if (stride == 0 || size < offset + channels) {
+        return 0;
+    }
+    size_t fit = (size - offset - channels) / stride + 1;
+    return std::min((size - offset) / stride, fit);
+}
+
+}
+
+/* Interleave channels into dst, so that frame i of channel c lands at
+ * dst[offset + i * stride + c].  The sources must all be the same size.
+ * Contiguous frames of 2, 4 and 8 channels are transposed in SIMD
+ * registers, and other layouts are copied a cache sized block of frames at
+ * a time, so dst is only streamed through once. */
 template <typename T>
-void pack(T &dst, uint32_t offset, uint32_t stride,
-          const T *src1, const T *src2=NULL,
-          const T *src3=NULL, const T *src4=NULL) {
-    if ((src2 && src2->size() != src1->size()) ||
-        (src3 && src3->size() != src1->size()) ||
-        (src4 && src4->size() != src1->size())) {
+void pack(T &dst, uint32_t offset, uint32_t stride, const T *const *srcs,
+          size_t channels) {
+    if (channels == 0) {
         return;
     }
+    for (size_t channel = 1; channel < channels; channel++) {
+        if (srcs[channel]->size() != srcs[0]->size()) {
+            return;
+        }
+    }
 
-    uint32_t dstCount = (dst.size() - offset) / stride;
+    size_t length = std::min(detail::frames(dst.size(), offset, stride,
+                                            channels),
+                             srcs[0]->size());
+    if (length == 0) {
+        return;
+    }
 
-    size_t length = std::min(dstCount, src1.size());
+    if (detail::Contiguous<T>::value) {
+        /* Wider layouts go eight channels at a time */
+        const float *group[8];
+        for (size_t first = 0; first < channels; first += 8) {
+            size_t count = std::min(channels - first, (size_t) 8);
+            for (size_t channel = 0; channel < count; channel++) {
+                group[channel] = detail::data(*srcs[first + channel]);
+            }
+            simd::kernels().pack(detail::data(dst) + offset + first, stride,
+                                 group, count, length);
+        }
+        return;
+    }
 
-    auto dstIt = dst.begin() + offset;
-    auto dstEnd = dstIt + stride * length;
-    auto srcIt = src1->begin();
-    for (; dstIt != dstEnd; dstIt+=stride, srcIt++) {
-        *dstIt = *srcIt;
+    for (size_t channel = 0; channel < channels; channel++) {
+        auto dstIt = dst.begin() + offset + channel;
+        auto srcIt = srcs[channel]->begin();
+        for (size_t i = 0; i < length; i++) {
+            dstIt[i * stride] = srcIt[i];
+        }
     }
+}
 
-    if (src2) {
-        dstIt = dst.begin() + offset + 1;
-        dstEnd = dstIt + stride * length + 1;
-        srcIt = src2->begin();
-        for (; dstIt != dstEnd; dstIt+=stride, srcIt++) {
-            *dstIt = *srcIt;
+template <typename T>
+void pack(T &dst, uint32_t offset, uint32_t stride,
+          const T *src1, const T *src2=NULL,
+          const T *src3=NULL, const T *src4=NULL) {
+    const T *srcs[] = {src1, src2, src3, src4};
+    size_t channels = 0;
+    while (channels < 4 && srcs[channels]) {
+        channels++;
+    }
+    pack(dst, offset, stride, srcs, channels);
+}
+
+/* Deinterleave src, the inverse of pack() */
+template <typename T>
+void unpack(const T &src, uint32_t offset, uint32_t stride, T *const *dsts,
+            size_t channels) {
+    if (channels == 0) {
+        return;
+    }
+    for (size_t channel = 1; channel < channels; channel++) {
+        if (dsts[channel]->size() != dsts[0]->size()) {
+            return;
         }
     }
 
+    size_t length = std::min(detail::frames(src.size(), offset, stride,
+                                            channels),
+                             dsts[0]->size());
+    if (length == 0) {
+        return;
+    }
 
-   if (src3) {
-        dstIt = dst.begin() + offset + 2;
-        dstEnd = dstIt + stride * length + 2;
-        srcIt = src3->begin();
-        for (; dstIt != dstEnd; dstIt+=stride, srcIt++) {
-            *dstIt = *srcIt;
+    if (detail::Contiguous<T>::value) {
+        float *group[8];
+        for (size_t first = 0; first < channels; first += 8) {
+            size_t count = std::min(channels - first, (size_t) 8);
+            for (size_t channel = 0; channel < count; channel++) {
+                group[channel] = detail::data(*dsts[first + channel]);
+            }
+            simd::kernels().unpack(group, count,
+                                   detail::data(src) + offset + first,
+                                   stride, length);
         }
+        return;
     }
 
-    if (src4) {
-        dstIt = dst.begin() + offset + 3;
-        dstEnd = dstIt + stride * length + 3;
-        srcIt = src4->begin();
-        for (; dstIt != dstEnd; dstIt+=stride, srcIt++) {
-            *dstIt = *srcIt;
+    for (size_t channel = 0; channel < channels; channel++) {
+        auto dstIt = dsts[channel]->begin();
+        auto srcIt = src.begin() + offset + channel;
+        for (size_t i = 0; i < length; i++) {
+            dstIt[i] = srcIt[i * stride];
         }
     }
 }
@@ -683,49 +1392,82 @@ template <typename T>
 void unpack(const T &src, uint32_t offset, uint32_t stride,
             T *dst1, T *dst2=NULL, T *dst3=NULL,
             T *dst4=NULL) {
-    if ((dst2 && dst2->size() != dst1->size()) ||
-        (dst3 && dst3->size() != dst1->size()) ||
-        (dst4 && dst4->size() != dst1->size())) {
-        return;
+    T *dsts[] = {dst1, dst2, dst3, dst4};
+    size_t channels = 0;
+    while (channels < 4 && dsts[channels]) {
+        channels++;
     }
+    unpack(src, offset, stride, dsts, channels);
+}
 
-    uint32_t srcCount = (src.size() - offset) / stride;
+/* Polynomial approximations of the transcendental functions, computing
+ * 4, 8 or 16 lanes at a time depending on simd::level().  The precision
+ * argument trades accuracy for speed.  Maximum errors measured against
+ * double precision libm, in units in the last place of the float result:
+ *
+ *            LOW     MEDIUM  HIGH
+ *   sin/cos  9500    26      2     |x| < 8192 where |result| > 1e-3
+ *                            6     |x| < 100, including near the zeros
+ *   tan      10300   36      6     |x| < 100
+ *   exp      1700    71      2     including denormal results
+ *   log      11500   210     2     positive normal and denormal x
+ *
+ * The error of tan grows near its poles for larger |x|, as the error of
+ * the argument reduction is amplified.  pow(x, y) is computed as
+ * exp(y * log(|x|)), so its error is that of exp plus |y * log(x)| times
+ * the absolute error of log.
+ *
+ * sin, cos and tan fall back to libm for |x| >= 8192, infinities and NaN.
+ * Special values otherwise follow libm: exp overflows to infinity, log
+ * gives -inf at zero and NaN below it, and pow handles negative bases with
+ * integer exponents, pow(x, 0) == pow(1, y) == 1, and zero and infinite
+ * bases. */
+namespace approx {
 
-    size_t length = std::min(srcCount, dst1.size());
+template <typename T>
+void sin(T &dst, const T &x, Precision precision=HIGH) {
+    size_t length = std::min(dst.size(), x.size());
+    detail::unary(simd::kernels().sin[precision], dst, x, length);
+}
 
-    auto dstIt = dst1->begin();
-    auto dstEnd = dstIt + length;
-    auto srcIt = src.begin() + offset;
-    for (; dstIt != dstEnd; dstIt++, srcIt+=stride) {
-        *dstIt = *srcIt;
-    }
+template <typename T>
+void cos(T &dst, const T &x, Precision precision=HIGH) {
+    size_t length = std::min(dst.size(), x.size());
+    detail::unary(simd::kernels().cos[precision], dst, x, length);
+}
 
-    if (dst2) {
-        dstIt = dst2->begin();
-        dstEnd = dstIt + length;
-        srcIt = src.begin() + offset + 1;
-        for (; dstIt != dstEnd; dstIt++, srcIt+=stride) {
-            *dstIt = *srcIt;
-        }
-    }
+template <typename T>
+void tan(T &dst, const T &x, Precision precision=HIGH) {
+    size_t length = std::min(dst.size(), x.size());
+    detail::unary(simd::kernels().tan[precision], dst, x, length);
+}
 
-    if (dst3) {
-        dstIt = dst3->begin();
-        dstEnd = dstIt + length;
-        srcIt = src.begin() + offset + 2;
-        for (; dstIt != dstEnd; dstIt++, srcIt+=stride) {
-            *dstIt = *srcIt;
-        }
-    }
+template <typename T>
+void exp(T &dst, const T &x, Precision precision=HIGH) {
+    size_t length = std::min(dst.size(), x.size());
+    detail::unary(simd::kernels().exp[precision], dst, x, length);
+}
+
+template <typename T>
+void log(T &dst, const T &x, Precision precision=HIGH) {
+    size_t length = std::min(dst.size(), x.size());
+    detail::unary(simd::kernels().log[precision], dst, x, length);
+}
+
+template <typename T>
+void pow(T &dst, const T &x, detail::Value<T> y,
+         Precision precision=HIGH) {
+    size_t length = std::min(dst.size(), x.size());
+    detail::binary(simd::kernels().powVS[precision], dst, x, y, length);
+}
+
+template <typename T>
+void pow(T &dst, const T &x, const T &y, Precision precision=HIGH) {
+    size_t length = std::min(dst.size(), x.size());
+    length = std::min(length, y.size());
+    detail::binary(simd::kernels().powVV[precision], dst, x, y, length);
+}
 
-    if (dst4) {
-        dstIt = dst4->begin();
-        dstEnd = dstIt + length;
-        srcIt = src.begin() + offset + 3;
-        for (; dstIt != dstEnd; dstIt++, srcIt+=stride) {
-            *dstIt = *srcIt;
-        }
-    }
 }
 
 }
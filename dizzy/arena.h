@@ -0,0 +1,194 @@
+#ifndef dizzy_arena_HPP
+#define dizzy_arena_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "dizzy/span.h"
+
+/* Preallocated scratch memory for block processing, so the audio thread
+ * never has to call malloc.  Memory is reserved once at setup and handed
+ * out as spans whose first element starts a 64 byte cache line, and whose
+ * storage is padded to a whole number of lines, so SIMD loads never split
+ * a line and neighbouring buffers never share one:
+ *
+ *     dizzy::Arena &arena = dizzy::Arena::local();
+ *     arena.reserve(1 << 20);              // at setup, may allocate
+ *     ...
+ *     {
+ *         dizzy::Arena::Scope scope(arena);  // per block, never allocates
+ *         dizzy::Span tmp = arena.allocate(frames);
+ *         dizzy::mul(tmp, x, gain);
+ *         ...
+ *     }                                    // tmp is freed here
+ *
+ * Neither Arena nor Pool is shared between threads: give each thread its
+ * own, e.g. with Arena::local(). */
+
+namespace dizzy {
+
+namespace detail {
+
+const size_t cacheLine = 64;
+
+inline size_t roundToLine(size_t bytes) {
+    return (bytes + cacheLine - 1) & ~(cacheLine - 1);
+}
+
+/* Bytes from malloc starting on a cache line, with the pointer malloc
+ * returned kept just before them */
+inline unsigned char *alignedAlloc(size_t bytes) {
+    if (!bytes) {
+        return NULL;
+    }
+    void *raw = std::malloc(bytes + cacheLine + sizeof(void *));
+    if (!raw) {
+        throw std::bad_alloc();
+    }
+    uintptr_t start = (uintptr_t) raw + sizeof(void *);
+    start = (start + cacheLine - 1) & ~(uintptr_t) (cacheLine - 1);
+    ((void **) start)[-1] = raw;
+    return (unsigned char *) start;
+}
+
+inline void alignedFree(unsigned char *p) {
+    if (p) {
+        std::free(((void **) p)[-1]);
+    }
+}
+
+}
+
+/* Bump allocator over one preallocated block.  allocate() takes the next
+ * lines of the block and a Scope gives back everything allocated since it
+ * was made when it ends, both in constant time.  When the block is used
+ * up allocate() returns an empty span, which dizzy functions treat as
+ * having nothing to do; size the arena for the largest block at setup. */
+class Arena {
+public:
+    explicit Arena(size_t bytes=0) : base(NULL), capacity(0), offset(0) {
+        reserve(bytes);
+    }
+
+    ~Arena() { detail::alignedFree(base); }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /* Arena for the calling thread, which holds nothing until reserved */
+    static Arena &local() {
+        static thread_local Arena arena;
+        return arena;
+    }
+
+    /* Grow the block to at least bytes.  This allocates, and frees every
+     * span handed out so far, so call it at setup and not inside a
+     * Scope. */
+    void reserve(size_t bytes) {
+        bytes = detail::roundToLine(bytes);
+        if (bytes > capacity) {
+            unsigned char *block = detail::alignedAlloc(bytes);
+            detail::alignedFree(base);
+            base = block;
+            capacity = bytes;
+        }
+        offset = 0;
+    }
+
+    /* n uninitialized elements, or an empty span if they do not fit */
+    template <typename F=float>
+    BasicSpan<F> allocate(size_t n) {
+        if (n > (capacity - offset) / sizeof(F)) {
+            return BasicSpan<F>();
+        }
+        F *p = reinterpret_cast<F *>(base + offset);
+        offset += detail::roundToLine(n * sizeof(F));
+        return BasicSpan<F>(p, n);
+    }
+
+    /* Free everything allocated */
+    void clear() { offset = 0; }
+
+    size_t size() const { return capacity; }
+    size_t used() const { return offset; }
+
+    /* Frees what the arena allocates during the Scope's lifetime when it
+     * ends.  Scopes nest, and must end in the reverse order they began. */
+    class Scope {
+    public:
+        explicit Scope(Arena &arena) : arena(arena), mark(arena.offset) {}
+        ~Scope() { arena.offset = mark; }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Arena &arena;
+        size_t mark;
+    };
+
+private:
+    unsigned char *base;
+    size_t capacity;
+    size_t offset;
+};
+
+/* Fixed number of equally sized buffers, each aligned like Arena's, taken
+ * and given back in any order in constant time, e.g. for the outputs of
+ * graph nodes which outlive a single call.  acquire() returns an empty
+ * span once every buffer is in use. */
+template <typename F>
+class BasicPool {
+public:
+    BasicPool(size_t size, size_t count) :
+            length(size), stride(detail::roundToLine(size * sizeof(F))),
+            base(detail::alignedAlloc(stride * count)) {
+        spare.reserve(count);
+        for (size_t i = count; i-- > 0;) {
+            spare.push_back(reinterpret_cast<F *>(base + i * stride));
+        }
+    }
+
+    ~BasicPool() { detail::alignedFree(base); }
+
+    BasicPool(const BasicPool &) = delete;
+    BasicPool &operator=(const BasicPool &) = delete;
+
+    BasicSpan<F> acquire() {
+        if (spare.empty()) {
+            return BasicSpan<F>();
+        }
+        F *p = spare.back();
+        spare.pop_back();
+        return BasicSpan<F>(p, length);
+    }
+
+    /* Give back a buffer from acquire().  Empty spans are ignored. */
+    void release(const BasicSpan<F> &buffer) {
+        if (buffer.data()) {
+            spare.push_back(buffer.data());
+        }
+    }
+
+    /* Elements per buffer, and buffers not in use */
+    size_t size() const { return length; }
+    size_t available() const { return spare.size(); }
+
+private:
+    size_t length;
+    size_t stride;
+    unsigned char *base;
+
+    /* Capacity for every buffer is reserved up front, so release() never
+     * allocates */
+    std::vector<F *> spare;
+};
+
+typedef BasicPool<float> Pool;
+typedef BasicPool<double> DoublePool;
+
+}
+
+#endif
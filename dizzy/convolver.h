@@ -0,0 +1,155 @@
+#ifndef dizzy_convolver_HPP
+#define dizzy_convolver_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include "dizzy.h"
+#include "dizzy/fft.h"
+
+namespace dizzy {
+
+/* Streaming convolution with a long impulse response, using uniformly
+ * partitioned overlap-save.  The impulse response is cut into partitions of
+ * blockSize samples whose spectra are kept, and each block of input is
+ * transformed once and multiplied against all of them from a frequency
+ * domain delay line.  The cost per sample grows with the number of
+ * partitions rather than the length of the impulse response.
+ *
+ * In BLOCK_LATENCY mode the output is delayed by blockSize samples.  In
+ * ZERO_LATENCY mode the first partition is convolved directly in the time
+ * domain instead, which covers exactly the delay of the partitioned part,
+ * so the output is not delayed at all; this costs blockSize multiply-adds
+ * per sample, so keep blockSize small.  process() takes any number of
+ * samples per call. */
+class Convolver {
+public:
+    enum Mode {BLOCK_LATENCY, ZERO_LATENCY};
+
+    template <typename T>
+    Convolver(const T &ir, size_t blockSize, Mode mode=BLOCK_LATENCY) :
+            blockSize(std::max(blockSize, (size_t) 1)), mode(mode),
+            fft(2 * this->blockSize), bins(this->blockSize + 1),
+            window(2 * this->blockSize, 0.0f),
+            result(2 * this->blockSize), output(this->blockSize, 0.0f),
+            chunk(this->blockSize), sumRe(bins), sumIm(bins), position(0),
+            current(0) {
+        size_t b = this->blockSize;
+        std::vector<float> taps(ir.begin(), ir.end());
+
+        size_t start = 0;
+        if (mode == ZERO_LATENCY) {
+            head.assign(taps.begin(),
+                        taps.begin() + std::min(b, taps.size()));
+            start = head.size();
+        }
+
+        std::vector<float> partition(2 * b);
+        for (size_t i = start; i < taps.size(); i += b) {
+            size_t n = std::min(b, taps.size() - i);
+            std::fill(partition.begin(), partition.end(), 0.0f);
+            std::copy(taps.begin() + i, taps.begin() + i + n,
+                      partition.begin());
+            irRe.push_back(std::vector<float>(bins));
+            irIm.push_back(std::vector<float>(bins));
+            fft.forward(irRe.back(), irIm.back(), partition);
+        }
+
+        inputRe.assign(irRe.size(), std::vector<float>(bins, 0.0f));
+        inputIm.assign(irRe.size(), std::vector<float>(bins, 0.0f));
+    }
+
+    /* Delay of the output relative to the input, in samples */
+    size_t latency() const {
+        return mode == ZERO_LATENCY ? 0 : blockSize;
+    }
+
+    template <typename T>
+    void process(T &dst, const T &x) {
+        size_t length = std::min(dst.size(), x.size());
+        auto dstIt = dst.begin();
+        auto xIt = x.begin();
+        simd::Kernels &kernels = simd::kernels();
+
+        for (size_t i = 0; i < length;) {
+            size_t n = std::min(length - i, blockSize - position);
+            float *in = window.data() + blockSize + position;
+            std::copy(xIt, xIt + n, in);
+
+            std::copy(output.begin() + position,
+                      output.begin() + position + n, chunk.begin());
+            for (size_t k = 0; k < head.size(); k++) {
+                kernels.maddVVS(chunk.data(), chunk.data(), in - k, head[k],
+                                n);
+            }
+            std::copy(chunk.begin(), chunk.begin() + n, dstIt);
+
+            position += n;
+            i += n;
+            xIt += n;
+            dstIt += n;
+            if (position == blockSize) {
+                processBlock();
+                position = 0;
+            }
+        }
+    }
+
+    /* Clear the input history, e.g. when the stream restarts */
+    void reset() {
+        std::fill(window.begin(), window.end(), 0.0f);
+        std::fill(output.begin(), output.end(), 0.0f);
+        for (size_t p = 0; p < inputRe.size(); p++) {
+            std::fill(inputRe[p].begin(), inputRe[p].end(), 0.0f);
+            std::fill(inputIm[p].begin(), inputIm[p].end(), 0.0f);
+        }
+        position = 0;
+    }
+
+private:
+    /* The window holds the previous and the current block of input */
+    void processBlock() {
+        size_t partitions = irRe.size();
+        if (partitions) {
+            current = current ? current - 1 : partitions - 1;
+            fft.forward(inputRe[current], inputIm[current], window);
+
+            mulCplx(sumRe, sumIm, inputRe[current], inputIm[current],
+                    irRe[0], irIm[0]);
+            for (size_t p = 1; p < partitions; p++) {
+                size_t slot = (current + p) % partitions;
+                maddCplx(sumRe, sumIm, sumRe, sumIm, inputRe[slot],
+                         inputIm[slot], irRe[p], irIm[p]);
+            }
+
+            fft.inverse(result, sumRe, sumIm);
+            std::copy(result.begin() + blockSize, result.end(),
+                      output.begin());
+        }
+
+        std::copy(window.begin() + blockSize, window.end(), window.begin());
+    }
+
+    size_t blockSize;
+    Mode mode;
+    FFT fft;
+    size_t bins;
+
+    std::vector<float> head;
+    std::vector<std::vector<float> > irRe, irIm;
+
+    /* Frequency domain delay line of input spectra, newest at current */
+    std::vector<std::vector<float> > inputRe, inputIm;
+
+    std::vector<float> window;
+    std::vector<float> result;
+    std::vector<float> output;
+    std::vector<float> chunk;
+    std::vector<float> sumRe, sumIm;
+    size_t position;
+    size_t current;
+};
+
+}
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef dizzy_expr_HPP
+#define dizzy_expr_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "dizzy.h"
+
+/* Lazy elementwise expressions.  Wrapping a container with lazy() lets the
+ * usual arithmetic operators and math functions build an expression tree
+ * instead of computing anything; eval() (or assigning to lazy(dst)) then
+ * runs the whole tree in a single loop with no temporary buffers:
+ *
+ *     dizzy::eval(dst, dizzy::clamp(dizzy::lazy(x) * gain + dizzy::lazy(y),
+ *                                   -1.0f, 1.0f));
+ *
+ * As with the eager functions the length is the shortest of the containers
+ * involved.  Each node computes in the element type of its operands, so
+ * double containers are evaluated in double, and mixing float and double
+ * operands promotes to double. */
+
+namespace dizzy {
+
+template <typename E, typename F>
+struct Expr {
+    typedef F value_type;
+
+    const E &self() const { return static_cast<const E &>(*this); }
+    F operator[](size_t i) const { return self()[i]; }
+    size_t size() const { return self().size(); }
+};
+
+template <typename T, typename E, typename F>
+void eval(T &dst, const Expr<E, F> &x);
+
+namespace expr {
+
+template <typename T>
+class Terminal : public Expr<Terminal<T>, detail::Value<T> > {
+public:
+    explicit Terminal(T &x) : x(&x) {}
+    Terminal(const Terminal &) = default;
+
+    detail::Value<T> operator[](size_t i) const { return (*x)[i]; }
+    size_t size() const { return x->size(); }
+
+    template <typename E, typename F>
+    Terminal &operator=(const Expr<E, F> &e) {
+        eval(*x, e);
+        return *this;
+    }
+
+    Terminal &operator=(const Terminal &e) {
+        eval(*x, e);
+        return *this;
+    }
+
+private:
+    T *x;
+};
+
+template <typename F>
+class Constant : public Expr<Constant<F>, F> {
+public:
+    explicit Constant(F value) : value(value) {}
+
+    F operator[](size_t) const { return value; }
+    size_t size() const { return std::numeric_limits<size_t>::max(); }
+
+private:
+    F value;
+};
+
+template <typename Op, typename A>
+class Unary : public Expr<Unary<Op, A>, typename A::value_type> {
+public:
+    typedef typename A::value_type F;
+
+    explicit Unary(const A &a) : a(a) {}
+
+    F operator[](size_t i) const { return Op::template apply<F>(a[i]); }
+    size_t size() const { return a.size(); }
+
+private:
+    A a;
+};
+
+template <typename A, typename B>
+struct Common {
+    typedef typename std::common_type<typename A::value_type,
+                                      typename B::value_type>::type type;
+};
+
+template <typename Op, typename A, typename B>
+class Binary : public Expr<Binary<Op, A, B>, typename Common<A, B>::type> {
+public:
+    typedef typename Common<A, B>::type F;
+
+    Binary(const A &a, const B &b) : a(a), b(b) {}
+
+    F operator[](size_t i) const {
+        return Op::template apply<F>(a[i], b[i]);
+    }
+    size_t size() const { return std::min(a.size(), b.size()); }
+
+private:
+    A a;
+    B b;
+};
+
+template <typename A>
+class Clamp : public Expr<Clamp<A>, typename A::value_type> {
+public:
+    typedef typename A::value_type F;
+
+    Clamp(const A &a, F xMin, F xMax) : a(a), xMin(xMin), xMax(xMax) {}
+
+    /* The same selects as dizzy::clamp, so the two agree on signed zeros
+     * and NaN */
+    F operator[](size_t i) const {
+        F v = a[i];
+        return v >= xMax ? xMax : (v <= xMin ? xMin : v);
+    }
+    size_t size() const { return a.size(); }
+
+private:
+    A a;
+    F xMin;
+    F xMax;
+};
+
+#define DIZZY_EXPR_OP1(name, expression)                                    \
+struct name {                                                               \
+    template <typename F> static F apply(F a) { return expression; }        \
+};
+
+#define DIZZY_EXPR_OP2(name, expression)                                    \
+struct name {                                                               \
+    template <typename F> static F apply(F a, F b) { return expression; }   \
+};
+
+DIZZY_EXPR_OP2(Add, a + b)
+DIZZY_EXPR_OP2(Sub, a - b)
+DIZZY_EXPR_OP2(Mul, a * b)
+DIZZY_EXPR_OP2(Div, a / b)
+DIZZY_EXPR_OP2(Pow, std::pow(a, b))
+
+DIZZY_EXPR_OP1(Neg, -a)
+DIZZY_EXPR_OP1(Abs, std::fabs(a))
+DIZZY_EXPR_OP1(Sqrt, std::sqrt(a))
+DIZZY_EXPR_OP1(Sin, std::sin(a))
+DIZZY_EXPR_OP1(Cos, std::cos(a))
+DIZZY_EXPR_OP1(Tan, std::tan(a))
+DIZZY_EXPR_OP1(Exp, std::exp(a))
+DIZZY_EXPR_OP1(Log, std::log(a))
+DIZZY_EXPR_OP1(Floor, std::floor(a))
+DIZZY_EXPR_OP1(Ceil, std::ceil(a))
+DIZZY_EXPR_OP1(Round, std::round(a))
+DIZZY_EXPR_OP1(Fract, a - std::floor(a))
+
+#undef DIZZY_EXPR_OP1
+#undef DIZZY_EXPR_OP2
+
+}
+
+template <typename T>
+expr::Terminal<T> lazy(T &x) {
+    return expr::Terminal<T>(x);
+}
+
+template <typename T>
+expr::Terminal<const T> lazy(const T &x) {
+    return expr::Terminal<const T>(x);
+}
+
+template <typename T, typename E, typename F>
+void eval(T &dst, const Expr<E, F> &x) {
+    const E &e = x.self();
+    size_t length = std::min(dst.size(), e.size());
+
+    auto dstIt = dst.begin();
+    auto dstEnd = dstIt + length;
+    for (size_t i = 0; dstIt != dstEnd; dstIt++, i++) {
+        *dstIt = e[i];
+    }
+}
+
+/* Scalar operands take the element type of the expression */
+#define DIZZY_EXPR_BINARY(name, op)                                         \
+template <typename A, typename FA, typename B, typename FB>                 \
+expr::Binary<expr::op, A, B> name(const Expr<A, FA> &a,                     \
+                                  const Expr<B, FB> &b) {                   \
+    return expr::Binary<expr::op, A, B>(a.self(), b.self());                \
+}                                                                           \
+                                                                            \
+template <typename A, typename F>                                           \
+expr::Binary<expr::op, A, expr::Constant<F> >                               \
+name(const Expr<A, F> &a, typename Expr<A, F>::value_type b) {              \
+    return expr::Binary<expr::op, A, expr::Constant<F> >(                   \
+        a.self(), expr::Constant<F>(b));                                    \
+}                                                                           \
+                                                                            \
+template <typename B, typename F>                                           \
+expr::Binary<expr::op, expr::Constant<F>, B>                                \
+name(typename Expr<B, F>::value_type a, const Expr<B, F> &b) {              \
+    return expr::Binary<expr::op, expr::Constant<F>, B>(                    \
+        expr::Constant<F>(a), b.self());                                    \
+}
+
+DIZZY_EXPR_BINARY(operator+, Add)
+DIZZY_EXPR_BINARY(operator-, Sub)
+DIZZY_EXPR_BINARY(operator*, Mul)
+DIZZY_EXPR_BINARY(operator/, Div)
+DIZZY_EXPR_BINARY(pow, Pow)
+
+#undef DIZZY_EXPR_BINARY
+
+#define DIZZY_EXPR_UNARY(name, op)                                          \
+template <typename A, typename F>                                           \
+expr::Unary<expr::op, A> name(const Expr<A, F> &a) {                        \
+    return expr::Unary<expr::op, A>(a.self());                              \
+}
+
+DIZZY_EXPR_UNARY(operator-, Neg)
+DIZZY_EXPR_UNARY(abs, Abs)
+DIZZY_EXPR_UNARY(sqrt, Sqrt)
+DIZZY_EXPR_UNARY(sin, Sin)
+DIZZY_EXPR_UNARY(cos, Cos)
+DIZZY_EXPR_UNARY(tan, Tan)
+DIZZY_EXPR_UNARY(exp, Exp)
+DIZZY_EXPR_UNARY(log, Log)
+DIZZY_EXPR_UNARY(floor, Floor)
+DIZZY_EXPR_UNARY(ceil, Ceil)
+DIZZY_EXPR_UNARY(round, Round)
+DIZZY_EXPR_UNARY(fract, Fract)
+
+#undef DIZZY_EXPR_UNARY
+
+template <typename A, typename F>
+expr::Clamp<A> clamp(const Expr<A, F> &a,
+                     typename Expr<A, F>::value_type xMin,
+                     typename Expr<A, F>::value_type xMax) {
+    return expr::Clamp<A>(a.self(), xMin, xMax);
+}
+
+}
+
+#endif
@@ -0,0 +1,413 @@
+#ifndef dizzy_fft_HPP
+#define dizzy_fft_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "dizzy.h"
+
+namespace dizzy {
+
+namespace fft {
+
+const double pi = 3.14159265358979323846;
+
+/* Precomputed factorization, digit reversal permutation and twiddles for a
+ * split complex mixed radix FFT of one size.  Plans are immutable, so one
+ * plan is shared by every FFT of the same size through get(). */
+class Plan {
+public:
+    explicit Plan(size_t size) : length(size), maxRadix(1) {
+        if (size == 0) {
+            return;
+        }
+
+        std::vector<size_t> factors = factorize(size);
+
+        /* Input element n goes to the mixed radix digit reversal of n, so
+         * that every sub-transform is contiguous */
+        permutation.reserve(size);
+        permute(factors, 0, 0, 1);
+
+        /* Combine sub-transforms from the innermost factor outwards */
+        size_t m = 1;
+        for (size_t i = factors.size(); i-- > 0;) {
+            Stage stage = {factors[i], m, twiddleRe.size(), rootRe.size()};
+            size_t span = stage.radix * m;
+            for (size_t r = 1; r < stage.radix; r++) {
+                for (size_t k = 0; k < m; k++) {
+                    double angle = -2.0 * pi * r * k / span;
+                    twiddleRe.push_back(std::cos(angle));
+                    twiddleIm.push_back(std::sin(angle));
+                }
+            }
+            if (stage.radix != 2 && stage.radix != 4) {
+                for (size_t j = 0; j < stage.radix; j++) {
+                    double angle = -2.0 * pi * j / stage.radix;
+                    rootRe.push_back(std::cos(angle));
+                    rootIm.push_back(std::sin(angle));
+                }
+            }
+            stages.push_back(stage);
+            maxRadix = std::max(maxRadix, stage.radix);
+            m = span;
+        }
+    }
+
+    /* Shared plan for size, created on first use.  Thread safe. */
+    static std::shared_ptr<const Plan> get(size_t size) {
+        static std::mutex mutex;
+        static std::map<size_t, std::weak_ptr<const Plan> > cache;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const Plan> plan = cache[size].lock();
+        if (!plan) {
+            plan = std::make_shared<const Plan>(size);
+            cache[size] = plan;
+        }
+        return plan;
+    }
+
+    size_t size() const { return length; }
+
+    /* Floats of scratch space needed by execute() */
+    size_t scratchSize() const { return 2 * maxRadix; }
+
+    /* Position of each output element in the input */
+    const std::vector<uint32_t> &order() const { return permutation; }
+
+    /* In place forward transform of data already permuted by order() */
+    void execute(float *re, float *im, float *scratch) const {
+        simd::Kernels &kernels = simd::kernels();
+        for (size_t i = 0; i < stages.size(); i++) {
+            const Stage &stage = stages[i];
+            size_t blocks = length / (stage.radix * stage.m);
+            const float *twRe = twiddleRe.data() + stage.twiddles;
+            const float *twIm = twiddleIm.data() + stage.twiddles;
+            if (stage.radix == 4) {
+                kernels.fftRadix4(re, im, twRe, twIm, stage.m, blocks);
+            }
+            else if (stage.radix == 2) {
+                kernels.fftRadix2(re, im, twRe, twIm, stage.m, blocks);
+            }
+            else {
+                radixN(stage, re, im, twRe, twIm, blocks, scratch);
+            }
+        }
+    }
+
+private:
+    struct Stage {
+        size_t radix;
+        size_t m;
+        size_t twiddles;
+        size_t roots;
+    };
+
+    /* Radix 4 first for the fewest passes, then 2, then odd factors */
+    static std::vector<size_t> factorize(size_t size) {
+        std::vector<size_t> factors;
+        while (size % 4 == 0) {
+            factors.push_back(4);
+            size /= 4;
+        }
+        if (size % 2 == 0) {
+            factors.push_back(2);
+            size /= 2;
+        }
+        for (size_t p = 3; p * p <= size; p += 2) {
+            while (size % p == 0) {
+                factors.push_back(p);
+                size /= p;
+            }
+        }
+        if (size > 1) {
+            factors.push_back(size);
+        }
+        return factors;
+    }
+
+    void permute(const std::vector<size_t> &factors, size_t factor,
+                 size_t offset, size_t stride) {
+        if (factor == factors.size()) {
+            permutation.push_back(offset);
+            return;
+        }
+
+        size_t radix = factors[factor];
+        for (size_t r = 0; r < radix; r++) {
+            permute(factors, factor + 1, offset + r * stride,
+                    stride * radix);
+        }
+    }
+
+    /* Butterfly for any other radix, as a direct DFT of radix points */
+    void radixN(const Stage &stage, float *re, float *im, const float *twRe,
+                const float *twIm, size_t blocks, float *scratch) const {
+        size_t radix = stage.radix, m = stage.m;
+        const float *wRe = rootRe.data() + stage.roots;
+        const float *wIm = rootIm.data() + stage.roots;
+        float *tRe = scratch, *tIm = scratch + radix;
+
+        for (size_t b = 0; b < blocks; b++, re += radix * m, im += radix * m) {
+            for (size_t k = 0; k < m; k++) {
+                tRe[0] = re[k];
+                tIm[0] = im[k];
+                for (size_t r = 1; r < radix; r++) {
+                    float xRe = re[r * m + k], xIm = im[r * m + k];
+                    float cRe = twRe[(r - 1) * m + k];
+                    float cIm = twIm[(r - 1) * m + k];
+                    tRe[r] = xRe * cRe - xIm * cIm;
+                    tIm[r] = xRe * cIm + xIm * cRe;
+                }
+
+                for (size_t q = 0; q < radix; q++) {
+                    float yRe = 0.0f, yIm = 0.0f;
+                    size_t j = 0;
+                    for (size_t r = 0; r < radix; r++) {
+                        yRe += tRe[r] * wRe[j] - tIm[r] * wIm[j];
+                        yIm += tRe[r] * wIm[j] + tIm[r] * wRe[j];
+                        j += q;
+                        j = j < radix ? j : j - radix;
+                    }
+                    re[q * m + k] = yRe;
+                    im[q * m + k] = yIm;
+                }
+            }
+        }
+    }
+
+    size_t length;
+    size_t maxRadix;
+    std::vector<Stage> stages;
+    std::vector<uint32_t> permutation;
+    std::vector<float> twiddleRe, twiddleIm;
+    std::vector<float> rootRe, rootIm;
+};
+
+}
+
+/* Fast Fourier transform of a fixed size, following the DSP API's FFT
+ * interface.  Any size works; sizes made of the factors 2, 3 and 5 are
+ * fastest, and powers of two run entirely on the SIMD radix-4 and radix-2
+ * kernels.
+ *
+ * Spectra use split real/imaginary containers as taken by mulCplx and
+ * friends.  The forward transforms are unscaled and the inverse transforms
+ * are scaled by 1 / size, so inverse(forward(x)) == x.  Inputs shorter
+ * than size are zero padded, and outputs are truncated to the destination.
+ *
+ * The real transforms use bins 0 to size / 2; forward() also fills in the
+ * conjugate symmetric upper half if the destination is long enough.  For
+ * even sizes they run as a complex transform of half the size.
+ *
+ * Each FFT owns its work buffers, so use one object per thread.  The plans
+ * behind them are shared between all FFTs of the same size. */
+class FFT {
+public:
+    explicit FFT(size_t size) :
+            plan(fft::Plan::get(size)), re(size), im(size),
+            spectrumRe(size + 1), spectrumIm(size + 1),
+            scratch(plan->scratchSize()) {
+        if (size % 2 == 0 && size > 0) {
+            halfPlan = fft::Plan::get(size / 2);
+            scratch.resize(std::max(scratch.size(), halfPlan->scratchSize()));
+            for (size_t k = 0; k <= size / 4; k++) {
+                double angle = -2.0 * fft::pi * k / size;
+                realTwRe.push_back(std::cos(angle));
+                realTwIm.push_back(std::sin(angle));
+            }
+        }
+    }
+
+    size_t size() const { return plan->size(); }
+
+    template <typename T>
+    void forwardCplx(T &dstReal, T &dstImag,
+                     const T &xReal, const T &xImag) {
+        gather(*plan, xReal, xImag);
+        plan->execute(re.data(), im.data(), scratch.data());
+        scatter(dstReal, dstImag, 1.0f);
+    }
+
+    template <typename T>
+    void inverseCplx(T &dstReal, T &dstImag,
+                     const T &xReal, const T &xImag) {
+        /* Swapping the real and imaginary parts on the way in and out
+         * turns the forward transform into the inverse */
+        gather(*plan, xImag, xReal);
+        plan->execute(re.data(), im.data(), scratch.data());
+        scatter(dstImag, dstReal, 1.0f / size());
+    }
+
+    template <typename T>
+    void forward(T &dstReal, T &dstImag, const T &x) {
+        size_t n = size();
+        if (!halfPlan) {
+            gatherReal(*plan, x);
+            plan->execute(re.data(), im.data(), scratch.data());
+            scatter(dstReal, dstImag, 1.0f);
+            return;
+        }
+
+        /* Transform the even samples as the real part and the odd samples
+         * as the imaginary part of a half size signal, then separate the
+         * two spectra and combine them */
+        size_t half = n / 2;
+        size_t xLength = x.size();
+        const std::vector<uint32_t> &order = halfPlan->order();
+        auto xIt = x.begin();
+        for (size_t i = 0; i < half; i++) {
+            size_t j = 2 * order[i];
+            re[i] = j < xLength ? xIt[j] : 0.0f;
+            im[i] = j + 1 < xLength ? xIt[j + 1] : 0.0f;
+        }
+        halfPlan->execute(re.data(), im.data(), scratch.data());
+
+        float dc = re[0] + im[0];
+        float nyquist = re[0] - im[0];
+        for (size_t k = 1; k <= half / 2; k++) {
+            size_t j = half - k;
+            float eRe = 0.5f * (re[k] + re[j]);
+            float eIm = 0.5f * (im[k] - im[j]);
+            float oRe = 0.5f * (im[k] + im[j]);
+            float oIm = 0.5f * (re[j] - re[k]);
+            float tRe = oRe * realTwRe[k] - oIm * realTwIm[k];
+            float tIm = oRe * realTwIm[k] + oIm * realTwRe[k];
+            re[k] = eRe + tRe;
+            im[k] = eIm + tIm;
+            re[j] = eRe - tRe;
+            im[j] = tIm - eIm;
+        }
+        re[0] = dc;
+        im[0] = 0.0f;
+        re[half] = nyquist;
+        im[half] = 0.0f;
+
+        size_t length = std::min(dstReal.size(), dstImag.size());
+        length = std::min(length, n);
+        auto reIt = dstReal.begin();
+        auto imIt = dstImag.begin();
+        for (size_t k = 0; k < length; k++) {
+            if (k <= half) {
+                reIt[k] = re[k];
+                imIt[k] = im[k];
+            }
+            else {
+                reIt[k] = re[n - k];
+                imIt[k] = -im[n - k];
+            }
+        }
+    }
+
+    template <typename T>
+    void inverse(T &dst, const T &xReal, const T &xImag) {
+        size_t n = size();
+        size_t length = std::min(dst.size(), n);
+        auto dstIt = dst.begin();
+
+        size_t bins = n / 2 + 1;
+        size_t reLength = std::min(xReal.size(), bins);
+        size_t imLength = std::min(xImag.size(), bins);
+        std::fill(spectrumRe.begin(), spectrumRe.end(), 0.0f);
+        std::fill(spectrumIm.begin(), spectrumIm.end(), 0.0f);
+        std::copy(xReal.begin(), xReal.begin() + reLength,
+                  spectrumRe.begin());
+        std::copy(xImag.begin(), xImag.begin() + imLength,
+                  spectrumIm.begin());
+
+        if (!halfPlan) {
+            /* Rebuild the conjugate symmetric upper half and run a full
+             * complex inverse */
+            for (size_t k = bins; k < n; k++) {
+                spectrumRe[k] = spectrumRe[n - k];
+                spectrumIm[k] = -spectrumIm[n - k];
+            }
+            gather(*plan, spectrumIm, spectrumRe);
+            plan->execute(re.data(), im.data(), scratch.data());
+            for (size_t i = 0; i < length; i++) {
+                dstIt[i] = im[i] / n;
+            }
+            return;
+        }
+
+        /* Undo the combination done by forward() to get back the half size
+         * spectrum of the even and odd samples */
+        size_t half = n / 2;
+        for (size_t k = 0; k <= half / 2; k++) {
+            size_t j = half - k;
+            float eRe = 0.5f * (spectrumRe[k] + spectrumRe[j]);
+            float eIm = 0.5f * (spectrumIm[k] - spectrumIm[j]);
+            float dRe = 0.5f * (spectrumRe[k] - spectrumRe[j]);
+            float dIm = 0.5f * (spectrumIm[k] + spectrumIm[j]);
+            float oRe = dRe * realTwRe[k] + dIm * realTwIm[k];
+            float oIm = dIm * realTwRe[k] - dRe * realTwIm[k];
+            spectrumRe[k] = eRe - oIm;
+            spectrumIm[k] = eIm + oRe;
+            spectrumRe[j] = eRe + oIm;
+            spectrumIm[j] = oRe - eIm;
+        }
+
+        gather(*halfPlan, spectrumIm, spectrumRe);
+        halfPlan->execute(re.data(), im.data(), scratch.data());
+
+        float scale = 1.0f / half;
+        for (size_t i = 0; i < length; i++) {
+            dstIt[i] = (i % 2 ? re[i / 2] : im[i / 2]) * scale;
+        }
+    }
+
+private:
+    template <typename T, typename U>
+    void gather(const fft::Plan &p, const T &xReal, const U &xImag) {
+        size_t reLength = xReal.size(), imLength = xImag.size();
+        const std::vector<uint32_t> &order = p.order();
+        auto reIt = xReal.begin();
+        auto imIt = xImag.begin();
+        for (size_t i = 0; i < p.size(); i++) {
+            uint32_t j = order[i];
+            re[i] = j < reLength ? reIt[j] : 0.0f;
+            im[i] = j < imLength ? imIt[j] : 0.0f;
+        }
+    }
+
+    template <typename T>
+    void gatherReal(const fft::Plan &p, const T &x) {
+        size_t xLength = x.size();
+        const std::vector<uint32_t> &order = p.order();
+        auto xIt = x.begin();
+        for (size_t i = 0; i < p.size(); i++) {
+            uint32_t j = order[i];
+            re[i] = j < xLength ? xIt[j] : 0.0f;
+            im[i] = 0.0f;
+        }
+    }
+
+    template <typename T>
+    void scatter(T &dstReal, T &dstImag, float scale) {
+        size_t length = std::min(dstReal.size(), dstImag.size());
+        length = std::min(length, size());
+        auto reIt = dstReal.begin();
+        auto imIt = dstImag.begin();
+        for (size_t i = 0; i < length; i++) {
+            reIt[i] = re[i] * scale;
+            imIt[i] = im[i] * scale;
+        }
+    }
+
+    std::shared_ptr<const fft::Plan> plan;
+    std::shared_ptr<const fft::Plan> halfPlan;
+    std::vector<float> re, im;
+    std::vector<float> spectrumRe, spectrumIm;
+    std::vector<float> scratch;
+    std::vector<float> realTwRe, realTwIm;
+};
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef dizzy_filter_HPP
+#define dizzy_filter_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "dizzy.h"
+
+namespace dizzy {
+
+/* General IIR filter following the DSP API's Filter interface:
+ *
+ *     y[k] = b[0] x[k] + ... + b[N] x[k - N] - a[1] y[k - 1] - ...
+ *            - a[M] y[k - M]
+ *
+ * with the coefficients normalized by a[0].  b and a can be changed between
+ * calls without losing the history.  For second order sections, and
+ * especially for many channels, BiquadFilter is much faster. */
+class Filter {
+public:
+    Filter(size_t bSize, size_t aSize) : b(bSize, 0.0f), a(aSize, 0.0f) {
+        if (bSize) {
+            b[0] = 1.0f;
+        }
+        if (aSize) {
+            a[0] = 1.0f;
+        }
+    }
+
+    template <typename T>
+    void filter(T &dst, const T &x) {
+        size_t order = std::max(std::max(b.size(), a.size()), (size_t) 1) - 1;
+        float scale = a.empty() || a[0] == 0.0f ? 1.0f : 1.0f / a[0];
+        bNorm.assign(order + 1, 0.0f);
+        aNorm.assign(order + 1, 0.0f);
+        for (size_t i = 0; i < b.size(); i++) {
+            bNorm[i] = b[i] * scale;
+        }
+        for (size_t i = 1; i < a.size(); i++) {
+            aNorm[i] = a[i] * scale;
+        }
+        history.resize(order + 1, 0.0f);
+        history[order] = 0.0f;
+
+        size_t length = std::min(dst.size(), x.size());
+        auto dstIt = dst.begin();
+        auto dstEnd = dstIt + length;
+        auto xIt = x.begin();
+        float *z = history.data();
+        for (; dstIt != dstEnd; dstIt++, xIt++) {
+            float in = *xIt;
+            float out = bNorm[0] * in + z[0];
+            for (size_t i = 1; i <= order; i++) {
+                z[i - 1] = z[i] + bNorm[i] * in - aNorm[i] * out;
+            }
+            *dstIt = out;
+        }
+    }
+
+    void clearHistory() {
+        std::fill(history.begin(), history.end(), 0.0f);
+    }
+
+    std::vector<float> b;
+    std::vector<float> a;
+
+private:
+    /* Transposed direct form II state, with a trailing zero */
+    std::vector<float> history;
+    std::vector<float> bNorm, aNorm;
+};
+
+/* Coefficients of one second order section, normalized so that a0 is 1.
+ * The designs are from Robert Bristow-Johnson's Audio EQ Cookbook, with
+ * frequencies given as a fraction of the sample rate. */
+struct Biquad {
+    float b0, b1, b2, a1, a2;
+
+    static Biquad lowpass(float frequency, float q) {
+        Design d(frequency, q);
+        return d.normalize((1.0f - d.cosW) / 2.0f, 1.0f - d.cosW,
+                           (1.0f - d.cosW) / 2.0f, 1.0f + d.alpha,
+                           -2.0f * d.cosW, 1.0f - d.alpha);
+    }
+
+    static Biquad highpass(float frequency, float q) {
+        Design d(frequency, q);
+        return d.normalize((1.0f + d.cosW) / 2.0f, -(1.0f + d.cosW),
+                           (1.0f + d.cosW) / 2.0f, 1.0f + d.alpha,
+                           -2.0f * d.cosW, 1.0f - d.alpha);
+    }
+
+    /* Constant 0 dB peak gain */
+    static Biquad bandpass(float frequency, float q) {
+        Design d(frequency, q);
+        return d.normalize(d.alpha, 0.0f, -d.alpha, 1.0f + d.alpha,
+                           -2.0f * d.cosW, 1.0f - d.alpha);
+    }
+
+    static Biquad peak(float frequency, float q, float gainDb) {
+        Design d(frequency, q);
+        float g = std::pow(10.0f, gainDb / 40.0f);
+        return d.normalize(1.0f + d.alpha * g, -2.0f * d.cosW,
+                           1.0f - d.alpha * g, 1.0f + d.alpha / g,
+                           -2.0f * d.cosW, 1.0f - d.alpha / g);
+    }
+
+    static Biquad lowShelf(float frequency, float q, float gainDb) {
+        Design d(frequency, q);
+        float g = std::pow(10.0f, gainDb / 40.0f);
+        float s = 2.0f * std::sqrt(g) * d.alpha;
+        return d.normalize(
+                g * ((g + 1.0f) - (g - 1.0f) * d.cosW + s),
+                2.0f * g * ((g - 1.0f) - (g + 1.0f) * d.cosW),
+                g * ((g + 1.0f) - (g - 1.0f) * d.cosW - s),
+                (g + 1.0f) + (g - 1.0f) * d.cosW + s,
+                -2.0f * ((g - 1.0f) + (g + 1.0f) * d.cosW),
+                (g + 1.0f) + (g - 1.0f) * d.cosW - s);
+    }
+
+    static Biquad highShelf(float frequency, float q, float gainDb) {
+        Design d(frequency, q);
+        float g = std::pow(10.0f, gainDb / 40.0f);
+        float s = 2.0f * std::sqrt(g) * d.alpha;
+        return d.normalize(
+                g * ((g + 1.0f) + (g - 1.0f) * d.cosW + s),
+                -2.0f * g * ((g - 1.0f) + (g + 1.0f) * d.cosW),
+                g * ((g + 1.0f) + (g - 1.0f) * d.cosW - s),
+                (g + 1.0f) - (g - 1.0f) * d.cosW + s,
+                2.0f * ((g - 1.0f) - (g + 1.0f) * d.cosW),
+                (g + 1.0f) - (g - 1.0f) * d.cosW - s);
+    }
+
+private:
+    struct Design {
+        Design(float frequency, float q) {
+            float w = 2.0f * 3.14159265f * frequency;
+            cosW = std::cos(w);
+            alpha = std::sin(w) / (2.0f * q);
+        }
+
+        Biquad normalize(float b0, float b1, float b2, float a0, float a1,
+                         float a2) const {
+            Biquad biquad = {b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0};
+            return biquad;
+        }
+
+        float cosW;
+        float alpha;
+    };
+};
+
+/* Cascade of biquad sections run a whole block at a time.  With more than
+ * one channel the input and output are interleaved frames, each channel
+ * has its own coefficients and history, and neighbouring channels are
+ * filtered together in the lanes of the SIMD registers, so eight or
+ * sixteen channels cost little more than one.  Every section starts out
+ * as a pass-through. */
+class BiquadFilter {
+public:
+    explicit BiquadFilter(size_t sections, size_t channels=1) :
+            sections(sections), channels(channels),
+            coefficients(5 * sections * channels, 0.0f),
+            state(2 * sections * channels, 0.0f),
+            buffer(channels * std::max((size_t) 1,
+                                       256 / std::max(channels, (size_t) 1))) {
+        Biquad identity = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        for (size_t s = 0; s < sections; s++) {
+            set(s, identity);
+        }
+    }
+
+    size_t numSections() const { return sections; }
+    size_t numChannels() const { return channels; }
+
+    /* Set a section for one channel, keeping its history */
+    void set(size_t section, const Biquad &biquad, size_t channel) {
+        float *k = coefficients.data() + 5 * section * channels + channel;
+        k[0] = biquad.b0;
+        k[channels] = biquad.b1;
+        k[2 * channels] = biquad.b2;
+        k[3 * channels] = -biquad.a1;
+        k[4 * channels] = -biquad.a2;
+    }
+
+    /* Set a section for every channel */
+    void set(size_t section, const Biquad &biquad) {
+        for (size_t c = 0; c < channels; c++) {
+            set(section, biquad, c);
+        }
+    }
+
+    /* Filter whole frames; a trailing partial frame is left untouched */
+    template <typename T>
+    void filter(T &dst, const T &x) {
+        if (channels == 0) {
+            return;
+        }
+        size_t length = std::min(dst.size(), x.size());
+        size_t frames = length / channels;
+        simd::Kernels &kernels = simd::kernels();
+        if (detail::Contiguous<T>::value) {
+            kernels.biquad(detail::data(dst), detail::data(x), frames,
+                           channels, coefficients.data(), state.data(),
+                           sections);
+            return;
+        }
+
+        size_t blockFrames = buffer.size() / channels;
+        auto dstIt = dst.begin();
+        auto xIt = x.begin();
+        for (size_t f = 0; f < frames; f += blockFrames) {
+            size_t n = std::min(frames - f, blockFrames) * channels;
+            std::copy(xIt, xIt + n, buffer.begin());
+            kernels.biquad(buffer.data(), buffer.data(), n / channels,
+                           channels, coefficients.data(), state.data(),
+                           sections);
+            std::copy(buffer.begin(), buffer.begin() + n, dstIt);
+            xIt += n;
+            dstIt += n;
+        }
+    }
+
+    void clearHistory() {
+        std::fill(state.begin(), state.end(), 0.0f);
+    }
+
+private:
+    size_t sections;
+    size_t channels;
+    std::vector<float> coefficients;
+    std::vector<float> state;
+    std::vector<float> buffer;
+};
+
+}
+
+#endif
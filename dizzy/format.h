@@ -0,0 +1,370 @@
+#ifndef dizzy_format_HPP
+#define dizzy_format_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "dizzy.h"
+
+namespace dizzy {
+
+/* Sample encodings used by audio devices and files, always little endian
+ * whatever the host.  Integers are two's complement with full scale at
+ * +-1.0f; INT24 is packed into three bytes.  FLOAT16 is IEEE half
+ * precision. */
+enum SampleFormat {
+    INT16,
+    INT24,
+    INT32,
+    FLOAT16
+};
+
+inline size_t sampleBytes(SampleFormat format) {
+    switch (format) {
+        case INT16:
+            return 2;
+        case INT24:
+            return 3;
+        case INT32:
+            return 4;
+        default:
+            return 2;
+    }
+}
+
+/* Triangular (TPDF) dither for encode(), optionally with error feedback
+ * noise shaping which moves the requantization noise away from the low
+ * frequencies where hearing is most sensitive, at the cost of more noise
+ * in total.  The dither is two uniform variables of one LSB each, which
+ * makes the mean and variance of the error independent of the signal.
+ *
+ * A Dither keeps the shaping state of each channel between calls, so use
+ * one per stream, made with at least as many channels as it encodes. */
+class Dither {
+public:
+    enum Shaping {
+        FLAT,
+        FIRST_ORDER,
+        SECOND_ORDER
+    };
+
+    explicit Dither(size_t channels, Shaping shaping=FLAT, uint64_t seed=0) :
+        channels(channels), shaping(shaping), random(seed),
+        error(2 * channels, 0.0f), noise(256), uniform(256) {}
+
+    size_t numChannels() const { return channels; }
+
+    void reset() {
+        std::fill(error.begin(), error.end(), 0.0f);
+    }
+
+    /* Quantize length samples of x to integers of the given scale and
+     * upper bound, as encode() does.  channel must be below
+     * numChannels(). */
+    void quantize(size_t channel, int32_t *dst, const float *x, size_t length,
+                  float scale, float high) {
+        assert(channel < channels);
+        simd::Kernels &kernels = simd::kernels();
+        for (size_t i = 0; i < length; i += noise.size()) {
+            size_t n = std::min(length - i, noise.size());
+            Span a(noise.data(), n), b(uniform.data(), n);
+            random.fill(a, -0.5f, 0.5f);
+            random.fill(b, -0.5f, 0.5f);
+            kernels.addVV(a.data(), a.data(), b.data(), n);
+
+            if (shaping == FLAT) {
+                kernels.quantize(dst + i, x + i, a.data(), scale, high, n);
+            }
+            else {
+                shape(channel, dst + i, x + i, a.data(), n, scale, high);
+            }
+        }
+    }
+
+private:
+    /* Subtracting the filtered error of earlier samples shapes the error
+     * spectrum by (1 - z^-1) or (1 - z^-1)^2 */
+    void shape(size_t channel, int32_t *dst, const float *x,
+               const float *dither, size_t length, float scale, float high) {
+        float e1 = error[2 * channel];
+        float e2 = error[2 * channel + 1];
+        bool second = shaping == SECOND_ORDER;
+        for (size_t i = 0; i < length; i++) {
+            float v = x[i] * scale - (second ? 2.0f * e1 - e2 : e1);
+            float q = std::nearbyint(v + dither[i]);
+            q = q > -scale ? (q < high ? q : high) : -scale;
+            dst[i] = (int32_t) q;
+
+            /* Unclipped errors are below 1.5 LSB; clipped ones are bounded
+             * to the same so the feedback stays stable */
+            e2 = e1;
+            e1 = std::max(-1.5f, std::min(q - v, 1.5f));
+        }
+        error[2 * channel] = e1;
+        error[2 * channel + 1] = e2;
+    }
+
+    size_t channels;
+    Shaping shaping;
+    Random random;
+    std::vector<float> error;
+    std::vector<float> noise;
+    std::vector<float> uniform;
+};
+
+namespace detail {
+
+const size_t formatBlock = 256;
+
+/* Integer value of full scale */
+inline float formatScale(SampleFormat format) {
+    switch (format) {
+        case INT16:
+            return 32768.0f;
+        case INT24:
+            return 8388608.0f;
+        default:
+            return 2147483648.0f;
+    }
+}
+
+/* Largest integer below full scale which converts from float exactly */
+inline float formatHigh(float scale) {
+    return std::min(scale - 1.0f, std::nextafter(scale, 0.0f));
+}
+
+/* Round to nearest even, with overflow to infinity and subnormals */
+inline uint16_t toHalf(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t bits = x & 0x7fffffff;
+
+    if (bits >= 0x7f800000) {
+        return sign | (bits > 0x7f800000 ? 0x7e00 : 0x7c00);
+    }
+    if (bits >= 0x477ff000) {
+        /* 65520 and up round past the largest half, 65504 */
+        return sign | 0x7c00;
+    }
+    if (bits < 0x38800000) {
+        /* Subnormal halves count in units of 2^-24 */
+        float magnitude = std::fabs(f);
+        return sign | (uint32_t) std::nearbyint(magnitude * 16777216.0f);
+    }
+    bits += 0xfff + ((bits >> 13) & 1);
+    return sign | ((bits - 0x38000000) >> 13);
+}
+
+inline float fromHalf(uint16_t h) {
+    uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+
+    if (exponent == 0) {
+        float f = mantissa * (1.0f / 16777216.0f);
+        return sign ? -f : f;
+    }
+
+    uint32_t bits = sign | (mantissa << 13);
+    bits |= exponent == 31 ? 0x7f800000 : (exponent + 112) << 23;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline void writeSample(unsigned char *dst, int32_t x, size_t bytes) {
+    uint32_t u = x;
+    for (size_t b = 0; b < bytes; b++) {
+        dst[b] = (unsigned char) (u >> (8 * b));
+    }
+}
+
+/* Sign extended from the top byte */
+inline int32_t readSample(const unsigned char *src, size_t bytes) {
+    uint32_t u = 0;
+    for (size_t b = 0; b < bytes; b++) {
+        u |= (uint32_t) src[b] << (8 * b);
+    }
+    size_t shift = 32 - 8 * bytes;
+    return (int32_t) (u << shift) >> shift;
+}
+
+/* Integers of one channel to and from interleaved frames.  The byte count
+ * is a constant in each loop, so they compile to plain loads and stores. */
+template <size_t Bytes>
+void writeSamples(unsigned char *dst, size_t frameBytes, const int32_t *x,
+                  size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        writeSample(dst + i * frameBytes, x[i], Bytes);
+    }
+}
+
+template <size_t Bytes>
+void readSamples(float *dst, const unsigned char *src, size_t frameBytes,
+                 size_t length, float scale) {
+    for (size_t i = 0; i < length; i++) {
+        dst[i] = readSample(src + i * frameBytes, Bytes) * scale;
+    }
+}
+
+inline void writeSamples(unsigned char *dst, size_t frameBytes,
+                         const int32_t *x, size_t length,
+                         SampleFormat format) {
+    switch (format) {
+        case INT16:
+            writeSamples<2>(dst, frameBytes, x, length);
+            break;
+        case INT24:
+            writeSamples<3>(dst, frameBytes, x, length);
+            break;
+        default:
+            writeSamples<4>(dst, frameBytes, x, length);
+            break;
+    }
+}
+
+inline void readSamples(float *dst, const unsigned char *src,
+                        size_t frameBytes, size_t length, float scale,
+                        SampleFormat format) {
+    switch (format) {
+        case INT16:
+            readSamples<2>(dst, src, frameBytes, length, scale);
+            break;
+        case INT24:
+            readSamples<3>(dst, src, frameBytes, length, scale);
+            break;
+        default:
+            readSamples<4>(dst, src, frameBytes, length, scale);
+            break;
+    }
+}
+
+}
+
+/* Encode float channels into interleaved frames of format at dst, as many
+ * as the shortest channel holds, returning how many.  dst must have room
+ * for that many frames.  Integer formats saturate at full scale, and are
+ * dithered if dither is given; a dither made for fewer channels encodes
+ * nothing.  Frames are converted a block at a time with the SIMD kernels,
+ * so the device buffer is only written once. */
+template <typename T>
+size_t encode(void *dst, SampleFormat format, const T *const *srcs,
+              size_t channels, Dither *dither=NULL) {
+    if (channels == 0 || (dither && dither->numChannels() < channels)) {
+        return 0;
+    }
+    size_t length = srcs[0]->size();
+    for (size_t channel = 1; channel < channels; channel++) {
+        length = std::min(length, srcs[channel]->size());
+    }
+
+    simd::Kernels &kernels = simd::kernels();
+    size_t bytes = sampleBytes(format);
+    size_t frameBytes = bytes * channels;
+    float scale = detail::formatScale(format);
+    float high = detail::formatHigh(scale);
+
+    float staged[detail::formatBlock];
+    int32_t quantized[detail::formatBlock];
+    unsigned char *out = static_cast<unsigned char *>(dst);
+    for (size_t i = 0; i < length; i += detail::formatBlock) {
+        size_t n = std::min(length - i, detail::formatBlock);
+        for (size_t channel = 0; channel < channels; channel++) {
+            const float *x = staged;
+            if (detail::Contiguous<T>::value) {
+                x = detail::data(*srcs[channel]) + i;
+            }
+            else {
+                std::copy(srcs[channel]->begin() + i,
+                          srcs[channel]->begin() + i + n, staged);
+            }
+
+            unsigned char *frames = out + i * frameBytes + channel * bytes;
+            if (format == FLOAT16) {
+                for (size_t j = 0; j < n; j++) {
+                    detail::writeSample(frames + j * frameBytes,
+                                        detail::toHalf(x[j]), 2);
+                }
+                continue;
+            }
+
+            if (dither) {
+                dither->quantize(channel, quantized, x, n, scale, high);
+            }
+            else {
+                kernels.quantize(quantized, x, NULL, scale, high, n);
+            }
+            detail::writeSamples(frames, frameBytes, quantized, n, format);
+        }
+    }
+    return length;
+}
+
+template <typename T>
+size_t encode(void *dst, SampleFormat format, const T &src,
+              Dither *dither=NULL) {
+    const T *srcs[] = {&src};
+    return encode(dst, format, srcs, 1, dither);
+}
+
+/* Decode interleaved frames of format at src into float channels, as many
+ * as the shortest channel holds, returning how many */
+template <typename T>
+size_t decode(T *const *dsts, size_t channels, const void *src,
+              SampleFormat format) {
+    if (channels == 0) {
+        return 0;
+    }
+    size_t length = dsts[0]->size();
+    for (size_t channel = 1; channel < channels; channel++) {
+        length = std::min(length, dsts[channel]->size());
+    }
+
+    size_t bytes = sampleBytes(format);
+    size_t frameBytes = bytes * channels;
+    float scale = 1.0f / detail::formatScale(format);
+
+    const unsigned char *in = static_cast<const unsigned char *>(src);
+    float staged[detail::formatBlock];
+    for (size_t i = 0; i < length; i += detail::formatBlock) {
+        size_t n = std::min(length - i, detail::formatBlock);
+        for (size_t channel = 0; channel < channels; channel++) {
+            float *x = staged;
+            if (detail::Contiguous<T>::value) {
+                x = detail::data(*dsts[channel]) + i;
+            }
+
+            const unsigned char *frames = in + i * frameBytes +
+                                          channel * bytes;
+            if (format == FLOAT16) {
+                for (size_t j = 0; j < n; j++) {
+                    x[j] = detail::fromHalf(
+                        detail::readSample(frames + j * frameBytes, 2));
+                }
+            }
+            else {
+                detail::readSamples(x, frames, frameBytes, n, scale, format);
+            }
+
+            if (!detail::Contiguous<T>::value) {
+                std::copy(staged, staged + n, dsts[channel]->begin() + i);
+            }
+        }
+    }
+    return length;
+}
+
+template <typename T>
+size_t decode(T &dst, const void *src, SampleFormat format) {
+    T *dsts[] = {&dst};
+    return decode(dsts, 1, src, format);
+}
+
+}
+
+#endif
@@ -0,0 +1,539 @@
+#ifndef dizzy_graph_HPP
+#define dizzy_graph_HPP
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "dizzy.h"
+#include "dizzy/arena.h"
+#include "dizzy/convolver.h"
+#include "dizzy/filter.h"
+#include "dizzy/parallel.h"
+
+/* Processing graphs built from dizzy functions, run a block at a time.
+ * Nodes take the blocks of earlier nodes and make one block each:
+ *
+ *     dizzy::Graph graph(256);
+ *     dizzy::Graph::Node x = graph.input();
+ *     dizzy::Graph::Node low = graph.biquad(x, {lowpass});
+ *     graph.output(graph.madd(x, low, 0.5f));
+ *     graph.compile();                   // at setup, allocates
+ *     ...
+ *     graph.process(outputs, inputs);    // per block, never allocates
+ *
+ * compile() drops nodes no output needs, fuses each run of elementwise
+ * nodes whose results have no other use into one pass over the block,
+ * and groups the rest into levels whose nodes do not depend on each
+ * other.  Block buffers are then shared between nodes whose lifetimes do
+ * not overlap, so memory follows the most blocks live at any one level
+ * rather than the number of nodes.  Given a thread pool, the nodes of a
+ * level run in parallel; that pays off when nodes do a lot of work per
+ * block, such as long convolutions. */
+
+namespace dizzy {
+
+namespace detail {
+
+/* Samples per pass of a fused run of elementwise nodes, whose
+ * intermediate results are kept in tiles this long */
+const size_t graphTile = 256;
+
+}
+
+class Graph {
+public:
+    typedef size_t Node;
+
+    /* Custom node, which fills dst from the blocks of its inputs.  All of
+     * them are dst.size() samples long. */
+    typedef std::function<void(Span, const std::vector<Span> &)> Function;
+
+    /* pool runs the nodes of each level in parallel; without one they run
+     * on the calling thread */
+    explicit Graph(size_t blockSize, parallel::ThreadPool *pool=NULL) :
+            blockSize(std::max(blockSize, (size_t) 1)), pool(pool),
+            inputs(0), compiled(false), bufferCount(0), silence(NULL),
+            length(0), first(0) {
+        runLevel = [this](size_t i) { run(tasks[first + i]); };
+    }
+
+    Graph(const Graph &) = delete;
+    Graph &operator=(const Graph &) = delete;
+
+    /* The next of the blocks passed to process() */
+    Node input() {
+        Vertex v(INPUT);
+        v.index = inputs++;
+        return append(v);
+    }
+
+    Node add(Node a, Node b) { return arithmetic(ADD, a, b); }
+    Node add(Node a, float b) { return arithmetic(ADD, a, b); }
+    Node sub(Node a, Node b) { return arithmetic(SUB, a, b); }
+    Node sub(Node a, float b) { return arithmetic(SUB, a, b); }
+    Node mul(Node a, Node b) { return arithmetic(MUL, a, b); }
+    Node mul(Node a, float b) { return arithmetic(MUL, a, b); }
+    Node div(Node a, Node b) { return arithmetic(DIV, a, b); }
+    Node div(Node a, float b) { return arithmetic(DIV, a, b); }
+
+    /* a + b * c, as dizzy::madd() */
+    Node madd(Node a, Node b, Node c) {
+        Vertex v(MADD);
+        v.args.push_back(a);
+        v.args.push_back(b);
+        v.args.push_back(c);
+        return append(v);
+    }
+
+    Node madd(Node a, Node b, float c) {
+        Vertex v(MADD);
+        v.args.push_back(a);
+        v.args.push_back(b);
+        v.scalar = true;
+        v.value = c;
+        return append(v);
+    }
+
+    /* Cascade of biquad sections, with its own history */
+    Node biquad(Node x, const std::vector<Biquad> &sections) {
+        std::shared_ptr<BiquadFilter> f =
+                std::make_shared<BiquadFilter>(sections.size());
+        for (size_t s = 0; s < sections.size(); s++) {
+            f->set(s, sections[s]);
+        }
+        return node(std::vector<Node>(1, x),
+                    [f](Span dst, const std::vector<Span> &in) {
+            f->filter(dst, in[0]);
+        });
+    }
+
+    /* Convolution with ir, delayed by one block */
+    Node convolve(Node x, const std::vector<float> &ir) {
+        std::shared_ptr<Convolver> c =
+                std::make_shared<Convolver>(ir, blockSize);
+        return node(std::vector<Node>(1, x),
+                    [c](Span dst, const std::vector<Span> &in) {
+            c->process(dst, in[0]);
+        });
+    }
+
+    Node node(const std::vector<Node> &args, const Function &function) {
+        Vertex v(FUNCTION);
+        v.args = args;
+        v.function = function;
+        return append(v);
+    }
+
+    /* Make n the next of the blocks process() writes, returning which */
+    size_t output(Node n) {
+        outputs.push_back(n);
+        compiled = false;
+        return outputs.size() - 1;
+    }
+
+    /* Schedule the graph and allocate its buffers.  process() calls it if
+     * nodes were added since, but it allocates, so call it at setup. */
+    void compile() {
+        size_t count = vertices.size();
+        std::vector<size_t> users(count, 0);
+        std::vector<bool> live(count, false), isOutput(count, false);
+        for (size_t k = 0; k < outputs.size(); k++) {
+            live[outputs[k]] = true;
+            isOutput[outputs[k]] = true;
+        }
+        for (size_t n = count; n-- > 0;) {
+            if (live[n]) {
+                for (size_t j = 0; j < vertices[n].args.size(); j++) {
+                    live[vertices[n].args[j]] = true;
+                    users[vertices[n].args[j]]++;
+                }
+            }
+        }
+
+        /* Elementwise nodes used once, by another elementwise node, are
+         * computed inside their user's pass.  Nodes are only ever added
+         * after their inputs, so their order is already topological, and
+         * each node's level follows from its inputs'. */
+        std::vector<size_t> root(count), level(count, 0);
+        for (size_t n = 0; n < count; n++) {
+            root[n] = n;
+        }
+        for (size_t n = count; n-- > 0;) {
+            for (size_t j = 0; live[n] && j < vertices[n].args.size(); j++) {
+                size_t a = vertices[n].args[j];
+                if (elementwise(n) && elementwise(a) && users[a] == 1 &&
+                    !isOutput[a]) {
+                    root[a] = root[n];
+                }
+            }
+        }
+        for (size_t n = 0; n < count; n++) {
+            for (size_t j = 0; live[n] && j < vertices[n].args.size(); j++) {
+                size_t a = vertices[n].args[j];
+                bool fused = root[a] == root[n];
+                level[n] = std::max(level[n], level[a] + (fused ? 0 : 1));
+            }
+        }
+
+        /* A task per unfused node, ordered by level */
+        tasks.clear();
+        for (size_t n = 0; n < count; n++) {
+            if (live[n] && root[n] == n && vertices[n].kind != INPUT) {
+                tasks.push_back(Task(n, level[n]));
+            }
+        }
+        std::stable_sort(tasks.begin(), tasks.end(),
+                         [](const Task &a, const Task &b) {
+            return a.level < b.level;
+        });
+        levels.clear();
+        for (size_t t = 0; t < tasks.size(); t++) {
+            if (t == 0 || tasks[t].level != tasks[t - 1].level) {
+                levels.push_back(t);
+            }
+        }
+        levels.push_back(tasks.size());
+
+        /* Each block is needed until the last level reading it, and
+         * outputs until the end */
+        std::vector<size_t> lastUse(count, 0);
+        for (size_t n = 0; n < count; n++) {
+            for (size_t j = 0; live[n] && j < vertices[n].args.size(); j++) {
+                size_t a = vertices[n].args[j];
+                lastUse[a] = std::max(lastUse[a], level[root[n]]);
+            }
+            if (isOutput[n]) {
+                lastUse[n] = size_t(-1);
+            }
+        }
+
+        /* Hand out buffers a level at a time, taking back those whose last
+         * reader ran at an earlier level */
+        std::vector<size_t> buffer(count, 0), spare, held;
+        size_t created = 0;
+        for (size_t l = 0; l + 1 < levels.size(); l++) {
+            size_t now = tasks[levels[l]].level;
+            for (size_t h = 0; h < held.size();) {
+                if (lastUse[held[h]] < now) {
+                    spare.push_back(buffer[held[h]]);
+                    held[h] = held.back();
+                    held.pop_back();
+                }
+                else {
+                    h++;
+                }
+            }
+            for (size_t t = levels[l]; t < levels[l + 1]; t++) {
+                size_t n = tasks[t].node;
+                if (spare.empty()) {
+                    spare.push_back(created++);
+                }
+                buffer[n] = spare.back();
+                spare.pop_back();
+                held.push_back(n);
+            }
+        }
+
+        /* Buffers, silence for inputs process() is not given, and tiles
+         * for the intermediate results of fused passes */
+        size_t tiles = 0;
+        for (size_t t = 0; t < tasks.size(); t++) {
+            tasks[t].tiles = tiles;
+            tiles += program(tasks[t], root);
+        }
+        size_t block = detail::roundToLine(blockSize * sizeof(float));
+        size_t tile = detail::graphTile * sizeof(float);
+        memory.reset(new Arena((created + 1) * block + tiles * tile));
+        bufferCount = created;
+        std::vector<float *> buffers(created);
+        for (size_t b = 0; b < created; b++) {
+            buffers[b] = memory->allocate(blockSize).data();
+        }
+        silence = memory->allocate(blockSize).data();
+        std::fill(silence, silence + blockSize, 0.0f);
+        float *scratch = memory->allocate(tiles * detail::graphTile).data();
+
+        blocks.assign(count, silence);
+        for (size_t t = 0; t < tasks.size(); t++) {
+            Task &task = tasks[t];
+            blocks[task.node] = buffers[buffer[task.node]];
+            task.scratch = scratch + task.tiles * detail::graphTile;
+            const Vertex &v = vertices[task.node];
+            task.spans.assign(v.kind == FUNCTION ? v.args.size() : 0,
+                              Span());
+        }
+        compiled = true;
+    }
+
+    /* Run the graph on one block.  inputs and outputs are in the order
+     * their nodes were made, inputs beyond those given read silence, and
+     * the block is the shortest of them, at most the block size.  Outputs
+     * must not overlap inputs. */
+    void process(const std::vector<Span> &outputSpans,
+                 const std::vector<Span> &inputSpans) {
+        if (!compiled) {
+            compile();
+        }
+        length = blockSize;
+        for (size_t i = 0; i < outputSpans.size(); i++) {
+            length = std::min(length, outputSpans[i].size());
+        }
+        for (size_t i = 0; i < inputSpans.size(); i++) {
+            length = std::min(length, inputSpans[i].size());
+        }
+        for (size_t n = 0; n < vertices.size(); n++) {
+            const Vertex &v = vertices[n];
+            if (v.kind == INPUT) {
+                blocks[n] = v.index < inputSpans.size() ?
+                            inputSpans[v.index].data() : silence;
+            }
+        }
+
+        for (size_t l = 0; l + 1 < levels.size(); l++) {
+            first = levels[l];
+            size_t n = levels[l + 1] - first;
+            if (pool && n > 1) {
+                pool->run(n, runLevel);
+                continue;
+            }
+            for (size_t t = 0; t < n; t++) {
+                run(tasks[first + t]);
+            }
+        }
+
+        for (size_t k = 0; k < outputs.size() && k < outputSpans.size();
+             k++) {
+            const float *y = blocks[outputs[k]];
+            std::copy(y, y + length, outputSpans[k].begin());
+        }
+    }
+
+    size_t numInputs() const { return inputs; }
+    size_t numOutputs() const { return outputs.size(); }
+
+    /* Block buffers the compiled graph shares between its nodes */
+    size_t numBuffers() const { return compiled ? bufferCount : 0; }
+
+    /* Passes over the block per call: one per custom node and one per
+     * fused run of elementwise nodes */
+    size_t numTasks() const { return tasks.size(); }
+
+private:
+    enum Kind {INPUT, ADD, SUB, MUL, DIV, MADD, FUNCTION};
+
+    struct Vertex {
+        explicit Vertex(Kind kind) :
+                kind(kind), scalar(false), value(0.0f), index(0) {}
+
+        Kind kind;
+        std::vector<Node> args;
+        bool scalar;
+        float value;
+        size_t index;
+        Function function;
+    };
+
+    /* An argument of a fused step: a tile of scratch, or a node's block */
+    struct Operand {
+        bool tile;
+        size_t at;
+    };
+
+    struct Step {
+        Kind kind;
+        bool scalar;
+        float value;
+        size_t args;
+        Operand arg[3];
+        Operand dst;
+    };
+
+    struct Task {
+        Task(Node node, size_t level) :
+                node(node), level(level), tiles(0), scratch(NULL) {}
+
+        Node node;
+        size_t level;
+        std::vector<Step> steps;
+        size_t tiles;
+        float *scratch;
+        std::vector<Span> spans;
+    };
+
+    Node append(const Vertex &v) {
+        vertices.push_back(v);
+        compiled = false;
+        return vertices.size() - 1;
+    }
+
+    Node arithmetic(Kind kind, Node a, Node b) {
+        Vertex v(kind);
+        v.args.push_back(a);
+        v.args.push_back(b);
+        return append(v);
+    }
+
+    Node arithmetic(Kind kind, Node a, float b) {
+        Vertex v(kind);
+        v.args.push_back(a);
+        v.scalar = true;
+        v.value = b;
+        return append(v);
+    }
+
+    bool elementwise(size_t n) const {
+        return vertices[n].kind != INPUT && vertices[n].kind != FUNCTION;
+    }
+
+    /* Fill in the steps of a task's fused pass, returning how many tiles
+     * of scratch they need.  A tile is free again once the step reading
+     * it has run. */
+    size_t program(Task &task, const std::vector<size_t> &root) {
+        task.steps.clear();
+        if (vertices[task.node].kind == FUNCTION) {
+            return 0;
+        }
+        std::vector<size_t> members;
+        for (size_t n = 0; n <= task.node; n++) {
+            if (root[n] == task.node) {
+                members.push_back(n);
+            }
+        }
+
+        std::vector<size_t> tileOf(task.node + 1, 0), spare;
+        size_t tiles = 0;
+        for (size_t m = 0; m < members.size(); m++) {
+            const Vertex &v = vertices[members[m]];
+            Step step = Step();
+            step.kind = v.kind;
+            step.scalar = v.scalar;
+            step.value = v.value;
+            step.args = v.args.size();
+            for (size_t j = 0; j < v.args.size(); j++) {
+                size_t a = v.args[j];
+                bool fused = root[a] == task.node && a != task.node;
+                step.arg[j].tile = fused;
+                step.arg[j].at = fused ? tileOf[a] : a;
+                if (fused) {
+                    spare.push_back(tileOf[a]);
+                }
+            }
+            step.dst.tile = members[m] != task.node;
+            step.dst.at = task.node;
+            if (step.dst.tile) {
+                if (spare.empty()) {
+                    spare.push_back(tiles++);
+                }
+                step.dst.at = tileOf[members[m]] = spare.back();
+                spare.pop_back();
+            }
+            task.steps.push_back(step);
+        }
+        return tiles;
+    }
+
+    float *address(const Task &task, const Operand &o, size_t offset) const {
+        return o.tile ? task.scratch + o.at * detail::graphTile :
+                        blocks[o.at] + offset;
+    }
+
+    void run(Task &task) {
+        const Vertex &v = vertices[task.node];
+        if (v.kind == FUNCTION) {
+            for (size_t j = 0; j < v.args.size(); j++) {
+                task.spans[j] = Span(blocks[v.args[j]], length);
+            }
+            v.function(Span(blocks[task.node], length), task.spans);
+            return;
+        }
+
+        simd::Kernels &kernels = simd::kernels();
+        for (size_t i = 0; i < length; i += detail::graphTile) {
+            size_t n = std::min(length - i, detail::graphTile);
+            for (size_t s = 0; s < task.steps.size(); s++) {
+                const Step &step = task.steps[s];
+                float *d = address(task, step.dst, i);
+                const float *a = address(task, step.arg[0], i);
+                const float *b = NULL, *c = NULL;
+                if (step.args > 1) {
+                    b = address(task, step.arg[1], i);
+                }
+                if (step.args > 2) {
+                    c = address(task, step.arg[2], i);
+                }
+                float y = step.value;
+                switch (step.kind) {
+                    case ADD:
+                        if (step.scalar) {
+                            kernels.addVS(d, a, y, n);
+                        }
+                        else {
+                            kernels.addVV(d, a, b, n);
+                        }
+                        break;
+                    case SUB:
+                        if (step.scalar) {
+                            kernels.subVS(d, a, y, n);
+                        }
+                        else {
+                            kernels.subVV(d, a, b, n);
+                        }
+                        break;
+                    case MUL:
+                        if (step.scalar) {
+                            kernels.mulVS(d, a, y, n);
+                        }
+                        else {
+                            kernels.mulVV(d, a, b, n);
+                        }
+                        break;
+                    case DIV:
+                        if (step.scalar) {
+                            kernels.divVS(d, a, y, n);
+                        }
+                        else {
+                            kernels.divVV(d, a, b, n);
+                        }
+                        break;
+                    case MADD:
+                        if (step.scalar) {
+                            kernels.maddVVS(d, a, b, y, n);
+                        }
+                        else {
+                            kernels.maddVVV(d, a, b, c, n);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+
+    size_t blockSize;
+    parallel::ThreadPool *pool;
+    std::vector<Vertex> vertices;
+    std::vector<Node> outputs;
+    size_t inputs;
+
+    /* The compiled schedule: tasks by level, with levels[l] the first
+     * task of level l, and the block each node's result is read from */
+    bool compiled;
+    std::vector<Task> tasks;
+    std::vector<size_t> levels;
+    std::vector<float *> blocks;
+    std::unique_ptr<Arena> memory;
+    size_t bufferCount;
+    float *silence;
+
+    /* State of the call in progress, for the tasks run by the pool */
+    size_t length;
+    size_t first;
+    std::function<void(size_t)> runLevel;
+};
+
+}
+
+#endif
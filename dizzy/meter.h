@@ -0,0 +1,361 @@
+#ifndef dizzy_meter_HPP
+#define dizzy_meter_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "dizzy.h"
+#include "dizzy/filter.h"
+#include "dizzy/span.h"
+
+namespace dizzy {
+
+namespace detail {
+
+const size_t meterBlock = 256;
+
+/* The 4x oversampling interpolator of ITU-R BS.1770-4 Annex 2, as twelve
+ * taps for each phase */
+const float truePeakFilter[simd::truePeakPhases][simd::truePeakTaps] = {
+    {0.0017089843750f, 0.0109863281250f, -0.0196533203125f,
+     0.0332031250000f, -0.0594482421875f, 0.1373291015625f,
+     0.9721679687500f, -0.1022949218750f, 0.0476074218750f,
+     -0.0266113281250f, 0.0148925781250f, -0.0083007812500f},
+    {-0.0291748046875f, 0.0292968750000f, -0.0517578125000f,
+     0.0891113281250f, -0.1665039062500f, 0.4650878906250f,
+     0.7797851562500f, -0.2003173828125f, 0.1015625000000f,
+     -0.0582275390625f, 0.0330810546875f, -0.0189208984375f},
+    {-0.0189208984375f, 0.0330810546875f, -0.0582275390625f,
+     0.1015625000000f, -0.2003173828125f, 0.7797851562500f,
+     0.4650878906250f, -0.1665039062500f, 0.0891113281250f,
+     -0.0517578125000f, 0.0292968750000f, -0.0291748046875f},
+    {-0.0083007812500f, 0.0148925781250f, -0.0266113281250f,
+     0.0476074218750f, -0.1022949218750f, 0.9721679687500f,
+     0.1373291015625f, -0.0594482421875f, 0.0332031250000f,
+     -0.0196533203125f, 0.0109863281250f, 0.0017089843750f}
+};
+
+/* The two stages of the BS.1770 K-weighting filter, a high shelf for the
+ * head and a high pass, redesigned for any sample rate */
+inline Biquad kShelf(double sampleRate) {
+    const double pi = 3.14159265358979323846;
+    double k = std::tan(pi * 1681.974450955533 / sampleRate);
+    double q = 0.7071752369554196;
+    double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    Biquad biquad = {(float) ((vh + vb * k / q + k * k) / a0),
+                     (float) (2.0 * (k * k - vh) / a0),
+                     (float) ((vh - vb * k / q + k * k) / a0),
+                     (float) (2.0 * (k * k - 1.0) / a0),
+                     (float) ((1.0 - k / q + k * k) / a0)};
+    return biquad;
+}
+
+inline Biquad kHighpass(double sampleRate) {
+    const double pi = 3.14159265358979323846;
+    double k = std::tan(pi * 38.13547087602444 / sampleRate);
+    double q = 0.5003270373238773;
+    double a0 = 1.0 + k / q + k * k;
+    Biquad biquad = {1.0f, -2.0f, 1.0f,
+                     (float) (2.0 * (k * k - 1.0) / a0),
+                     (float) ((1.0 - k / q + k * k) / a0)};
+    return biquad;
+}
+
+inline double loudness(double energy) {
+    return -0.691 + 10.0 * std::log10(energy);
+}
+
+}
+
+/* Streaming level and loudness meter for interleaved frames.  For each
+ * channel it follows the sample peak, the true peak of the signal
+ * oversampled four times, and the RMS level over a rolling window, and
+ * over all channels the EBU R128 momentary (400 ms), short-term (3 s) and
+ * integrated loudness of BS.1770.
+ *
+ * Nothing is kept per sample: the rolling window is ten slots of peaks and
+ * energies, so it moves a tenth of a window at a time, and loudness is
+ * measured in 100 ms steps, with the gated blocks of the integrated
+ * loudness counted into a histogram of 0.1 LU bins.  Everything is
+ * allocated by the constructor.  Levels are linear, loudness is in LUFS,
+ * and either is 0 or -inf before any input. */
+class Meter {
+public:
+    Meter(size_t channels, float sampleRate, float window=0.3f) :
+            channels(channels),
+            slotLength(std::max((size_t) 1,
+                                (size_t) (window * sampleRate / slots +
+                                          0.5f))),
+            stepLength(std::max((size_t) 1,
+                                (size_t) (sampleRate / 10.0f + 0.5f))),
+            weights(channels, 1.0f), weighting(2, channels),
+            planar(channels * planarStride),
+            weighted(channels * detail::meterBlock),
+            frames(channels * detail::meterBlock),
+            slotPeak(channels * slots), slotTruePeak(channels * slots),
+            slotEnergy(channels * slots), stepEnergy(shortTermSteps),
+            histogramCount(histogramBins), histogramEnergy(histogramBins) {
+        weighting.set(0, detail::kShelf(sampleRate));
+        weighting.set(1, detail::kHighpass(sampleRate));
+        reset();
+    }
+
+    size_t numChannels() const { return channels; }
+
+    /* Loudness weight of a channel: 1 by default, 1.41 for the surround
+     * channels of a 5.1 layout and 0 for its LFE */
+    void setWeight(size_t channel, float weight) {
+        weights[channel] = weight;
+    }
+
+    void reset() {
+        weighting.clearHistory();
+        std::fill(planar.begin(), planar.end(), 0.0f);
+        std::fill(slotPeak.begin(), slotPeak.end(), 0.0f);
+        std::fill(slotTruePeak.begin(), slotTruePeak.end(), 0.0f);
+        std::fill(slotEnergy.begin(), slotEnergy.end(), 0.0);
+        std::fill(stepEnergy.begin(), stepEnergy.end(), 0.0);
+        std::fill(histogramCount.begin(), histogramCount.end(), 0);
+        std::fill(histogramEnergy.begin(), histogramEnergy.end(), 0.0);
+        slot = 0;
+        slotPosition = 0;
+        fullSlots = 0;
+        stepPosition = 0;
+        steps = 0;
+        stepWeighted = 0.0;
+    }
+
+    /* Meter whole frames; a trailing partial frame is ignored */
+    template <typename T>
+    void process(const T &x) {
+        if (channels == 0) {
+            return;
+        }
+        size_t length = x.size() / channels;
+        auto xIt = x.begin();
+        for (size_t i = 0; i < length;) {
+            size_t n = std::min(length - i, detail::meterBlock);
+            n = std::min(n, slotLength - slotPosition);
+            n = std::min(n, stepLength - stepPosition);
+            if (detail::Contiguous<T>::value) {
+                meter(detail::data(x) + i * channels, n);
+            }
+            else {
+                std::copy(xIt, xIt + n * channels, frames.begin());
+                meter(frames.data(), n);
+            }
+            xIt += n * channels;
+            i += n;
+        }
+    }
+
+    /* Largest sample magnitude over the window */
+    float peak(size_t channel) const {
+        return largest(slotPeak, channel);
+    }
+
+    /* Largest magnitude between samples over the window, following
+     * BS.1770 with its 48 kHz interpolator at any rate */
+    float truePeak(size_t channel) const {
+        return largest(slotTruePeak, channel);
+    }
+
+    float rms(size_t channel) const {
+        size_t length = fullSlots * slotLength + slotPosition;
+        if (length == 0) {
+            return 0.0f;
+        }
+        double energy = 0.0;
+        for (size_t s = 0; s < slots; s++) {
+            energy += slotEnergy[channel * slots + s];
+        }
+        return std::sqrt(energy / length);
+    }
+
+    /* Loudness over the last 400 ms and 3 s of completed steps, or over
+     * all of them until there are enough */
+    float momentary() const {
+        return recent(momentarySteps);
+    }
+
+    float shortTerm() const {
+        return recent(shortTermSteps);
+    }
+
+    /* Gated loudness of everything since the start or reset() */
+    float integrated() const {
+        uint64_t count = 0;
+        double energy = 0.0;
+        for (size_t b = 0; b < histogramBins; b++) {
+            count += histogramCount[b];
+            energy += histogramEnergy[b];
+        }
+        if (count == 0) {
+            return -std::numeric_limits<float>::infinity();
+        }
+
+        /* Blocks in the bin of the relative gate are all counted, which
+         * is within 0.1 LU of exact */
+        size_t first = bin(detail::loudness(energy / count) - 10.0);
+        count = 0;
+        energy = 0.0;
+        for (size_t b = first; b < histogramBins; b++) {
+            count += histogramCount[b];
+            energy += histogramEnergy[b];
+        }
+        return detail::loudness(energy / count);
+    }
+
+private:
+    static const size_t slots = 10;
+    static const size_t planarStride =
+            simd::truePeakTaps - 1 + detail::meterBlock;
+    static const size_t momentarySteps = 4;
+    static const size_t shortTermSteps = 30;
+    static const size_t histogramBins = 1000;
+
+    /* Histogram bins from the absolute gate at -70 LUFS up, with louder
+     * blocks in the last */
+    static size_t bin(double loudness) {
+        double b = (loudness + 70.0) * 10.0;
+        return b > 0.0 ? std::min((size_t) b, histogramBins - 1) : 0;
+    }
+
+    float largest(const std::vector<float> &slotValues,
+                  size_t channel) const {
+        const float *values = slotValues.data() + channel * slots;
+        return *std::max_element(values, values + slots);
+    }
+
+    float recent(size_t window) const {
+        size_t count = std::min(steps, window);
+        if (count == 0) {
+            return -std::numeric_limits<float>::infinity();
+        }
+        return detail::loudness(meanStep(count));
+    }
+
+    double meanStep(size_t count) const {
+        double energy = 0.0;
+        for (size_t s = 1; s <= count; s++) {
+            energy += stepEnergy[(steps - s) % shortTermSteps];
+        }
+        return energy / count;
+    }
+
+    /* Meter n frames which stay within one slot and one step */
+    void meter(const float *x, size_t n) {
+        simd::Kernels &kernels = simd::kernels();
+        const size_t history = simd::truePeakTaps - 1;
+
+        /* Each channel's samples follow the interpolator's history */
+        float *group[8];
+        for (size_t first = 0; first < channels; first += 8) {
+            size_t count = std::min(channels - first, (size_t) 8);
+            for (size_t c = 0; c < count; c++) {
+                group[c] = planar.data() + (first + c) * planarStride +
+                           history;
+            }
+            kernels.unpack(group, count, x + first, channels, n);
+        }
+
+        if (x != frames.data()) {
+            std::copy(x, x + n * channels, frames.begin());
+        }
+        Span k(frames.data(), n * channels);
+        weighting.filter(k, k);
+        for (size_t first = 0; first < channels; first += 8) {
+            size_t count = std::min(channels - first, (size_t) 8);
+            for (size_t c = 0; c < count; c++) {
+                group[c] = weighted.data() + (first + c) * detail::meterBlock;
+            }
+            kernels.unpack(group, count, frames.data() + first, channels, n);
+        }
+
+        for (size_t c = 0; c < channels; c++) {
+            float *samples = planar.data() + c * planarStride + history;
+            float *kSamples = weighted.data() + c * detail::meterBlock;
+            stepWeighted += weights[c] * kernels.dot(kSamples, kSamples, n);
+
+            size_t i = c * slots + slot;
+            slotEnergy[i] += kernels.dot(samples, samples, n);
+            float lo, hi;
+            kernels.minmax(&lo, &hi, samples, n);
+            slotPeak[i] = std::max(slotPeak[i], std::max(hi, -lo));
+            float interpolated = kernels.truePeak(
+                    samples, &detail::truePeakFilter[0][0], n);
+            slotTruePeak[i] = std::max(slotTruePeak[i],
+                                       std::max(slotPeak[i], interpolated));
+
+            std::copy(samples + n - history, samples + n, samples - history);
+        }
+
+        slotPosition += n;
+        if (slotPosition == slotLength) {
+            slot = (slot + 1) % slots;
+            slotPosition = 0;
+            fullSlots = std::min(fullSlots + 1, slots - 1);
+            for (size_t c = 0; c < channels; c++) {
+                slotPeak[c * slots + slot] = 0.0f;
+                slotTruePeak[c * slots + slot] = 0.0f;
+                slotEnergy[c * slots + slot] = 0.0;
+            }
+        }
+
+        stepPosition += n;
+        if (stepPosition == stepLength) {
+            stepEnergy[steps % shortTermSteps] = stepWeighted / stepLength;
+            steps++;
+            stepPosition = 0;
+            stepWeighted = 0.0;
+
+            /* Gating blocks are 400 ms long and overlap by 75% */
+            if (steps >= momentarySteps) {
+                double energy = meanStep(momentarySteps);
+                if (detail::loudness(energy) > -70.0) {
+                    size_t b = bin(detail::loudness(energy));
+                    histogramCount[b]++;
+                    histogramEnergy[b] += energy;
+                }
+            }
+        }
+    }
+
+    size_t channels;
+    size_t slotLength;
+    size_t stepLength;
+    std::vector<float> weights;
+    BiquadFilter weighting;
+
+    /* Scratch for one block of each channel */
+    std::vector<float> planar;
+    std::vector<float> weighted;
+    std::vector<float> frames;
+
+    /* The rolling window, with slot the one being filled */
+    std::vector<float> slotPeak;
+    std::vector<float> slotTruePeak;
+    std::vector<double> slotEnergy;
+    size_t slot;
+    size_t slotPosition;
+    size_t fullSlots;
+
+    /* Loudness steps, with the last shortTermSteps step energies in a
+     * ring */
+    std::vector<double> stepEnergy;
+    size_t stepPosition;
+    size_t steps;
+    double stepWeighted;
+
+    std::vector<uint64_t> histogramCount;
+    std::vector<double> histogramEnergy;
+};
+
+}
+
+#endif
@@ -0,0 +1,430 @@
+#ifndef dizzy_parallel_HPP
+#define dizzy_parallel_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dizzy.h"
+
+/* Multithreaded overloads of the elementwise functions, for offline work on
+ * very large buffers.  Passing an execution policy as the first argument,
+ * in the style of the C++17 parallel algorithms, splits the buffers into
+ * cache sized tiles which are spread over a persistent thread pool:
+ *
+ *     dizzy::mul(dizzy::execution::par, dst, x, y);
+ *
+ * Buffers shorter than the policy's threshold are processed serially on
+ * the calling thread without touching the pool, so realtime code pays
+ * nothing for the overloads.  Results are identical to the serial
+ * functions. */
+
+namespace dizzy {
+
+namespace parallel {
+
+/* Fixed set of worker threads which run one batch of tasks at a time,
+ * together with the thread which submitted them.  Tasks are claimed from a
+ * shared counter, so idle threads keep taking work until the batch is
+ * done.  If the pool is already busy with another caller's batch, run()
+ * does the work on the calling thread instead of waiting. */
+class ThreadPool {
+public:
+    /* threads counts the calling thread, so 1 means no workers */
+    explicit ThreadPool(size_t threads=std::thread::hardware_concurrency()) :
+            job(NULL), tasks(0), active(0), generation(0), stopping(false) {
+        threads = std::max(threads, (size_t) 1);
+        for (size_t i = 1; i < threads; i++) {
+            workers.push_back(std::thread(&ThreadPool::work, this));
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+    }
+
+    /* Pool shared by all parallel calls, created on first use */
+    static ThreadPool &shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t size() const { return workers.size() + 1; }
+
+    /* Call task(i) for every i in [0, count), returning when all are done */
+    void run(size_t count, const std::function<void(size_t)> &task) {
+        std::unique_lock<std::mutex> busy(submit, std::try_to_lock);
+        if (!busy.owns_lock() || workers.empty()) {
+            for (size_t i = 0; i < count; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &task;
+            tasks = count;
+            next = 0;
+            generation++;
+        }
+        wake.notify_all();
+
+        claim(task, count);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return active == 0; });
+        job = NULL;
+    }
+
+private:
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+    void claim(const std::function<void(size_t)> &task, size_t count) {
+        for (size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    }
+
+    void work() {
+        unsigned seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&]() {
+                return stopping || generation != seen;
+            });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            if (!job) {
+                continue;
+            }
+
+            const std::function<void(size_t)> &task = *job;
+            size_t count = tasks;
+            active++;
+            lock.unlock();
+            claim(task, count);
+            lock.lock();
+            if (--active == 0) {
+                done.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex submit;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(size_t)> *job;
+    size_t tasks;
+    std::atomic<size_t> next;
+    size_t active;
+    unsigned generation;
+    bool stopping;
+};
+
+}
+
+namespace execution {
+
+/* Tiles of tile samples are processed in parallel once a call covers at
+ * least threshold samples.  The default tile keeps a few 64KB streams per
+ * thread in L2.  pool defaults to ThreadPool::shared(). */
+struct ParallelPolicy {
+    ParallelPolicy(size_t threshold=1 << 18, size_t tile=1 << 14,
+                   parallel::ThreadPool *pool=NULL) :
+        threshold(threshold), tile(std::max(tile, (size_t) 64)), pool(pool) {}
+
+    size_t threshold;
+    size_t tile;
+    parallel::ThreadPool *pool;
+};
+
+const ParallelPolicy par;
+
+}
+
+namespace detail {
+
+/* Random access iterator pair, for slicing containers which can't be
+ * viewed by a Span */
+template <typename It>
+class Range {
+public:
+    typedef typename std::iterator_traits<It>::value_type value_type;
+
+    Range(It first, It last) : first(first), last(last) {}
+
+    It begin() const { return first; }
+    It end() const { return last; }
+    size_t size() const { return last - first; }
+    typename std::iterator_traits<It>::reference operator[](size_t i) const {
+        return first[i];
+    }
+
+private:
+    It first;
+    It last;
+};
+
+/* Slices of a container of the same type for every argument, so that the
+ * serial functions can be reused on each tile.  Contiguous containers are
+ * sliced into spans of their element type to keep the SIMD paths.  Const
+ * arguments are sliced through a const_cast, as the functions never write
+ * to them. */
+template <typename T, bool = Contiguous<T, Value<T> >::value>
+struct Slice {
+    typedef BasicSpan<Value<T> > type;
+
+    static type get(const T &x, size_t begin, size_t end) {
+        T &y = const_cast<T &>(x);
+        return type(Contiguous<T, Value<T> >::data(y) + begin, end - begin);
+    }
+};
+
+template <typename T>
+struct Slice<T, false> {
+    typedef Range<typename T::iterator> type;
+
+    static type get(const T &x, size_t begin, size_t end) {
+        T &y = const_cast<T &>(x);
+        return type(y.begin() + begin, y.begin() + end);
+    }
+};
+
+template <typename T>
+typename Slice<T>::type slice(const T &x, size_t begin, size_t end) {
+    return Slice<T>::get(x, begin, end);
+}
+
+template <typename T>
+typename Slice<T>::type whole(const T &x) {
+    return Slice<T>::get(x, 0, x.size());
+}
+
+/* Run body(begin, end) over [0, length), in parallel tiles if length is
+ * over the policy's threshold */
+inline void forTiles(const execution::ParallelPolicy &policy, size_t length,
+                     const std::function<void(size_t, size_t)> &body) {
+    if (length < policy.threshold) {
+        body(0, length);
+        return;
+    }
+
+    parallel::ThreadPool &pool = policy.pool ? *policy.pool :
+                                 parallel::ThreadPool::shared();
+    size_t tile = policy.tile;
+    size_t tiles = (length + tile - 1) / tile;
+    pool.run(tiles, [&](size_t i) {
+        body(i * tile, std::min((i + 1) * tile, length));
+    });
+}
+
+}
+
+#define DIZZY_PARALLEL_UNARY(name)                                          \
+template <typename T>                                                       \
+void name(const execution::ParallelPolicy &policy, T &dst, const T &x) {   \
+    size_t length = std::min(dst.size(), x.size());                         \
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {              \
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);       \
+        name(d, detail::slice(x, b, e));                                    \
+    });                                                                     \
+}
+
+#define DIZZY_PARALLEL_BINARY(name)                                         \
+template <typename T>                                                       \
+void name(const execution::ParallelPolicy &policy, T &dst, const T &x,     \
+          const T &y) {                                                     \
+    size_t length = std::min(std::min(dst.size(), x.size()), y.size());     \
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {              \
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);       \
+        name(d, detail::slice(x, b, e), detail::slice(y, b, e));            \
+    });                                                                     \
+}
+
+#define DIZZY_PARALLEL_BINARY_SCALAR(name)                                  \
+template <typename T>                                                       \
+void name(const execution::ParallelPolicy &policy, T &dst, const T &x,     \
+          detail::Value<T> y) {                                             \
+    size_t length = std::min(dst.size(), x.size());                         \
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {              \
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);       \
+        name(d, detail::slice(x, b, e), y);                                 \
+    });                                                                     \
+}
+
+DIZZY_PARALLEL_BINARY(add)
+DIZZY_PARALLEL_BINARY(sub)
+DIZZY_PARALLEL_BINARY(mul)
+DIZZY_PARALLEL_BINARY(div)
+DIZZY_PARALLEL_BINARY(pow)
+DIZZY_PARALLEL_BINARY(atan2)
+DIZZY_PARALLEL_BINARY_SCALAR(add)
+DIZZY_PARALLEL_BINARY_SCALAR(sub)
+DIZZY_PARALLEL_BINARY_SCALAR(mul)
+DIZZY_PARALLEL_BINARY_SCALAR(div)
+DIZZY_PARALLEL_BINARY_SCALAR(pow)
+
+DIZZY_PARALLEL_UNARY(abs)
+DIZZY_PARALLEL_UNARY(sin)
+DIZZY_PARALLEL_UNARY(cos)
+DIZZY_PARALLEL_UNARY(tan)
+DIZZY_PARALLEL_UNARY(acos)
+DIZZY_PARALLEL_UNARY(asin)
+DIZZY_PARALLEL_UNARY(atan)
+DIZZY_PARALLEL_UNARY(ceil)
+DIZZY_PARALLEL_UNARY(floor)
+DIZZY_PARALLEL_UNARY(round)
+DIZZY_PARALLEL_UNARY(exp)
+DIZZY_PARALLEL_UNARY(log)
+DIZZY_PARALLEL_UNARY(sqrt)
+DIZZY_PARALLEL_UNARY(fract)
+DIZZY_PARALLEL_UNARY(sign)
+
+template <typename T>
+void madd(const execution::ParallelPolicy &policy, T &dst, const T &x,
+          const T &y, detail::Value<T> z) {
+    size_t length = std::min(std::min(dst.size(), x.size()), y.size());
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);
+        madd(d, detail::slice(x, b, e), detail::slice(y, b, e), z);
+    });
+}
+
+template <typename T>
+void madd(const execution::ParallelPolicy &policy, T &dst, const T &x,
+          const T &y, const T &z) {
+    size_t length = std::min(std::min(dst.size(), x.size()),
+                             std::min(y.size(), z.size()));
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);
+        madd(d, detail::slice(x, b, e), detail::slice(y, b, e),
+             detail::slice(z, b, e));
+    });
+}
+
+template <typename T>
+void mulCplx(const execution::ParallelPolicy &policy,
+             T &dstReal, T &dstImag, const T &xReal, const T &xImag,
+             const T &yReal, const T &yImag) {
+    size_t length = std::min(std::min(dstReal.size(), dstImag.size()),
+                             std::min(xReal.size(), xImag.size()));
+    length = std::min(length, std::min(yReal.size(), yImag.size()));
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type re = detail::slice(dstReal, b, e);
+        typename detail::Slice<T>::type im = detail::slice(dstImag, b, e);
+        mulCplx(re, im, detail::slice(xReal, b, e),
+                detail::slice(xImag, b, e), detail::slice(yReal, b, e),
+                detail::slice(yImag, b, e));
+    });
+}
+
+template <typename T>
+void absCplx(const execution::ParallelPolicy &policy, T &dst,
+             const T &xReal, const T &xImag) {
+    size_t length = std::min(std::min(dst.size(), xReal.size()),
+                             xImag.size());
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);
+        absCplx(d, detail::slice(xReal, b, e), detail::slice(xImag, b, e));
+    });
+}
+
+template <typename T>
+void clamp(const execution::ParallelPolicy &policy, T &dst, const T &x,
+           detail::Value<T> xMin, detail::Value<T> xMax) {
+    size_t length = std::min(dst.size(), x.size());
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);
+        clamp(d, detail::slice(x, b, e), xMin, xMax);
+    });
+}
+
+/* The table x is shared by every tile */
+template <typename T>
+void sampleLinear(const execution::ParallelPolicy &policy, T &dst,
+                  const T &x, const T &t, bool repeat=false) {
+    size_t length = std::min(dst.size(), t.size());
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);
+        sampleLinear(d, detail::whole(x), detail::slice(t, b, e), repeat);
+    });
+}
+
+template <typename T>
+void sampleCubic(const execution::ParallelPolicy &policy, T &dst,
+                 const T &x, const T &t, bool repeat=false) {
+    size_t length = std::min(dst.size(), t.size());
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);
+        sampleCubic(d, detail::whole(x), detail::slice(t, b, e), repeat);
+    });
+}
+
+namespace approx {
+
+#define DIZZY_PARALLEL_APPROX(name)                                         \
+template <typename T>                                                       \
+void name(const execution::ParallelPolicy &policy, T &dst, const T &x,     \
+          Precision precision=HIGH) {                                       \
+    size_t length = std::min(dst.size(), x.size());                         \
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {              \
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);       \
+        name(d, detail::slice(x, b, e), precision);                         \
+    });                                                                     \
+}
+
+DIZZY_PARALLEL_APPROX(sin)
+DIZZY_PARALLEL_APPROX(cos)
+DIZZY_PARALLEL_APPROX(tan)
+DIZZY_PARALLEL_APPROX(exp)
+DIZZY_PARALLEL_APPROX(log)
+
+#undef DIZZY_PARALLEL_APPROX
+
+template <typename T>
+void pow(const execution::ParallelPolicy &policy, T &dst, const T &x,
+         detail::Value<T> y, Precision precision=HIGH) {
+    size_t length = std::min(dst.size(), x.size());
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);
+        pow(d, detail::slice(x, b, e), y, precision);
+    });
+}
+
+template <typename T>
+void pow(const execution::ParallelPolicy &policy, T &dst, const T &x,
+         const T &y, Precision precision=HIGH) {
+    size_t length = std::min(std::min(dst.size(), x.size()), y.size());
+    detail::forTiles(policy, length, [&](size_t b, size_t e) {
+        typename detail::Slice<T>::type d = detail::slice(dst, b, e);
+        pow(d, detail::slice(x, b, e), detail::slice(y, b, e), precision);
+    });
+}
+
+}
+
+#undef DIZZY_PARALLEL_UNARY
+#undef DIZZY_PARALLEL_BINARY
+#undef DIZZY_PARALLEL_BINARY_SCALAR
+
+}
+
+#endif
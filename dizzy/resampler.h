@@ -0,0 +1,301 @@
+#ifndef dizzy_resampler_HPP
+#define dizzy_resampler_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "dizzy.h"
+#include "dizzy/window.h"
+
+namespace dizzy {
+
+namespace detail {
+
+/* Kaiser windowed sinc low pass, t samples from the centre of a filter
+ * spanning taps samples, with cutoff as a fraction of the sample rate */
+inline double windowedSinc(double t, double cutoff, size_t taps,
+                           double beta) {
+    const double pi = 3.14159265358979323846;
+    double r = t / (taps / 2.0);
+    if (r <= -1.0 || r >= 1.0) {
+        return 0.0;
+    }
+    double window = besselI0(beta * std::sqrt(1.0 - r * r)) /
+                    besselI0(beta);
+    double x = pi * 2.0 * cutoff * t;
+    return 2.0 * cutoff * window * (x == 0.0 ? 1.0 : std::sin(x) / x);
+}
+
+const size_t resampleInput = 1024;
+const size_t resampleOutput = 256;
+
+inline size_t gcd(size_t a, size_t b) {
+    while (b) {
+        size_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+}
+
+/* Band-limited sample rate conversion of a stream with a polyphase FIR
+ * filter, a Kaiser windowed sinc whose cutoff sits just below the lower
+ * of the two Nyquist frequencies.
+ *
+ * Integer rates in a ratio of L / M with L up to maxPhases use a bank of
+ * the L phases the output ever needs, stepping M / L input samples per
+ * output exactly.  Other ratios, and any Resampler made variable, use a
+ * bank of finely spaced phases and interpolate the filter between the two
+ * around each output, so the ratio can change from block to block with
+ * setRatio().
+ *
+ * Output k is the input at time k / ratio(), and is written once taps / 2
+ * inputs past that time have been read.  One Resampler converts one
+ * channel. */
+class Resampler {
+public:
+    static const size_t maxPhases = 1024;
+    static const size_t variablePhases = 256;
+
+    /* taps is per phase, and grows with the ratio when downsampling so
+     * the transition band stays as narrow relative to the new Nyquist
+     * frequency */
+    Resampler(double inputRate, double outputRate, size_t taps=64,
+              bool variable=false) :
+            factor(outputRate / inputRate), design(factor), length(taps) {
+        size_t in = (size_t) inputRate, out = (size_t) outputRate;
+        size_t g = in == inputRate && out == outputRate && in && out ?
+                   detail::gcd(in, out) : 0;
+        if (!variable && g && out / g <= maxPhases) {
+            phases = out / g;
+            stride = in / g;
+            build(false);
+        }
+        else {
+            phases = variablePhases;
+            stride = 0;
+            build(true);
+        }
+        step = 1.0 / factor;
+        reserve();
+        reset();
+    }
+
+    /* Output samples per input sample */
+    double ratio() const { return factor; }
+
+    /* Filter taps per output, a multiple of simd::polyphaseAlign */
+    size_t numTaps() const { return taps; }
+
+    /* Change the ratio from the next output on.  The filter stays
+     * designed for the ratio the Resampler was made with, so make it for
+     * the lowest ratio the stream will use.  A Resampler made for a fixed
+     * ratio switches to interpolated phases first, which allocates. */
+    void setRatio(double ratio) {
+        if (!variable) {
+            fraction = (double) phase / phases;
+            phases = variablePhases;
+            build(true);
+        }
+        factor = ratio;
+        step = 1.0 / ratio;
+        reserve();
+    }
+
+    /* Most outputs that length more inputs can give */
+    size_t maxOutput(size_t length) const {
+        return (size_t) (length * factor) + 2;
+    }
+
+    /* Resample x into dst and return the number of samples written.  All
+     * of x is read if dst has room for maxOutput(x.size()); otherwise
+     * reading stops when dst is full, and read gives how far it got. */
+    template <typename T>
+    size_t process(T &dst, const T &x, size_t *read=NULL) {
+        simd::Kernels &kernels = simd::kernels();
+        size_t inputs = x.size(), room = dst.size();
+        size_t consumed = 0, written = 0;
+        auto xIt = x.begin();
+        auto dstIt = dst.begin();
+        for (;;) {
+            size_t count = schedule(room - written);
+            if (count) {
+                float *out = staging.data();
+                if (detail::Contiguous<T>::value) {
+                    out = detail::data(dst) + written;
+                }
+                kernels.polyphase(out, buffer.data(), offsets.data(),
+                                  rows.data(),
+                                  variable ? weights.data() : NULL, taps,
+                                  count);
+                if (!detail::Contiguous<T>::value) {
+                    dstIt = std::copy(out, out + count, dstIt);
+                }
+                written += count;
+                continue;
+            }
+            if (written == room || consumed == inputs) {
+                break;
+            }
+
+            /* Drop the samples no output needs any more and read on */
+            size_t drop = std::min(index, filled);
+            std::copy(buffer.begin() + drop, buffer.begin() + filled,
+                      buffer.begin());
+            filled -= drop;
+            index -= drop;
+            size_t n = std::min(inputs - consumed, buffer.size() - filled);
+            std::copy(xIt, xIt + n, buffer.begin() + filled);
+            xIt += n;
+            filled += n;
+            consumed += n;
+        }
+        if (read) {
+            *read = consumed;
+        }
+        return written;
+    }
+
+    /* Clear the input history, e.g. when the stream restarts */
+    void reset() {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        filled = taps / 2 - 1;
+        index = 0;
+        phase = 0;
+        fraction = 0.0;
+    }
+
+private:
+    /* Tap j of phase p, whose output lies p / phases of a sample after
+     * the input under tap taps / 2 - 1 */
+    double tap(size_t p, size_t j, double cutoff) const {
+        double t = (double) p / phases + taps / 2.0 - 1.0 - j;
+        return detail::windowedSinc(t, cutoff, taps, 8.0);
+    }
+
+    void build(bool interpolate) {
+        variable = interpolate;
+        double scale = std::min(1.0, design);
+        size_t aligned = simd::polyphaseAlign;
+        taps = (size_t) std::ceil(length / scale / aligned) * aligned;
+        taps = std::max(taps, aligned);
+        double cutoff = 0.45 * scale;
+
+        /* Each phase is normalized to unit gain at DC, and interpolated
+         * banks keep each phase's difference to the next after it */
+        size_t rowSize = interpolate ? 2 * taps : taps;
+        std::vector<double> row(taps), next(taps);
+        bank.assign(phases * rowSize, 0.0f);
+        for (size_t p = 0; p < phases; p++) {
+            normalized(row, p, cutoff);
+            float *dst = bank.data() + p * rowSize;
+            for (size_t j = 0; j < taps; j++) {
+                dst[j] = (float) row[j];
+            }
+            if (interpolate) {
+                normalized(next, p + 1, cutoff);
+                for (size_t j = 0; j < taps; j++) {
+                    dst[taps + j] = (float) (next[j] - row[j]);
+                }
+            }
+        }
+    }
+
+    /* The buffer holds a block of input past the filter, or more if an
+     * output can step further, keeping what it holds */
+    void reserve() {
+        size_t needed = taps + std::max(detail::resampleInput,
+                                        (size_t) step + 1);
+        if (buffer.size() < needed) {
+            buffer.resize(needed, 0.0f);
+        }
+        offsets.resize(detail::resampleOutput);
+        rows.resize(detail::resampleOutput);
+        weights.resize(detail::resampleOutput);
+        staging.resize(detail::resampleOutput);
+    }
+
+    void normalized(std::vector<double> &row, size_t p, double cutoff) const {
+        double sum = 0.0;
+        for (size_t j = 0; j < taps; j++) {
+            row[j] = tap(p, j, cutoff);
+            sum += row[j];
+        }
+        for (size_t j = 0; j < taps; j++) {
+            row[j] /= sum;
+        }
+    }
+
+    /* Queue up to room outputs whose inputs are all buffered.  The state
+     * is copied to locals, which writes to offsets cannot alias. */
+    size_t schedule(size_t room) {
+        room = std::min(room, detail::resampleOutput);
+        size_t at = index, p = phase, count = 0;
+        size_t end = filled - std::min(filled, taps - 1);
+        if (variable) {
+            double f = fraction, s = step;
+            for (; count < room && at < end; count++) {
+                double position = f * phases;
+                size_t row = std::min((size_t) position, phases - 1);
+                offsets[count] = at;
+                rows[count] = bank.data() + 2 * row * taps;
+                weights[count] = (float) (position - row);
+                f += s;
+                size_t whole = (size_t) f;
+                at += whole;
+                f -= whole;
+            }
+            fraction = f;
+        }
+        else {
+            size_t whole = stride / phases, part = stride % phases;
+            size_t n = phases;
+            const float *first = bank.data();
+            for (; count < room && at < end; count++) {
+                offsets[count] = at;
+                rows[count] = first + p * taps;
+                p += part;
+                bool carry = p >= n;
+                at += whole + carry;
+                p -= carry ? n : 0;
+            }
+            phase = p;
+        }
+        index = at;
+        return count;
+    }
+
+    double factor;
+    double design;
+    size_t length;
+    size_t taps;
+    bool variable;
+
+    /* Rows of taps, one per phase, and for fixed ratios the input step
+     * per output in phases */
+    std::vector<float> bank;
+    size_t phases;
+    size_t stride;
+    double step;
+
+    /* Buffered input from the first sample the next output needs at
+     * index, and the next output's phase */
+    std::vector<float> buffer;
+    size_t filled;
+    size_t index;
+    size_t phase;
+    double fraction;
+
+    /* One block of scheduled outputs */
+    std::vector<size_t> offsets;
+    std::vector<const float *> rows;
+    std::vector<float> weights;
+    std::vector<float> staging;
+};
+
+}
+
+#endif
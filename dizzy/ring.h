@@ -0,0 +1,282 @@
+#ifndef dizzy_ring_HPP
+#define dizzy_ring_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "dizzy/span.h"
+#include "dizzy/arena.h"
+
+/* Lock-free queues for handing audio between threads without copying.
+ * Rather than pushing and popping buffers, a thread asks for the region it
+ * may write or read, works on it in place with any dizzy function, and
+ * then commits it:
+ *
+ *     dizzy::Ring::Region free = ring.writable();    // I/O thread
+ *     dizzy::unpack(device, 0, 2, &free.first);
+ *     ...
+ *     ring.commitWrite(n);
+ *
+ *     dizzy::Ring::Region ready = ring.readable();   // DSP thread
+ *     dizzy::mul(ready.first, ready.first, gain);
+ *     dizzy::mul(ready.second, ready.second, gain);
+ *     ring.commitRead(ready.size());
+ *
+ * The positions each side writes are kept a cache line apart, and nothing
+ * allocates after construction. */
+
+namespace dizzy {
+
+namespace detail {
+
+/* Ticket of a block queue claim which found nothing */
+const size_t noTicket = size_t(-1);
+
+inline size_t powerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p *= 2;
+    }
+    return p;
+}
+
+}
+
+/* Single producer, single consumer ring of samples.  Every call is
+ * wait-free.  A region which runs past the end of the storage comes as
+ * two spans, the second starting at the beginning. */
+template <typename F>
+class BasicRing {
+public:
+    struct Region {
+        BasicSpan<F> first;
+        BasicSpan<F> second;
+
+        size_t size() const { return first.size() + second.size(); }
+    };
+
+    /* Holds at least capacity samples, rounded up to a power of two */
+    explicit BasicRing(size_t capacity) :
+            length(detail::powerOfTwo(capacity)), mask(length - 1),
+            base(detail::alignedAlloc(length * sizeof(F))),
+            data(reinterpret_cast<F *>(base)), writePosition(0),
+            readPosition(0) {}
+
+    ~BasicRing() { detail::alignedFree(base); }
+
+    BasicRing(const BasicRing &) = delete;
+    BasicRing &operator=(const BasicRing &) = delete;
+
+    size_t capacity() const { return length; }
+
+    /* Free space, for the producer */
+    Region writable() {
+        size_t at = writePosition.load(std::memory_order_relaxed);
+        size_t limit = readPosition.load(std::memory_order_acquire) + length;
+        return region(at, limit - at);
+    }
+
+    /* Publish the first n samples of writable() to the consumer */
+    void commitWrite(size_t n) {
+        size_t at = writePosition.load(std::memory_order_relaxed);
+        writePosition.store(at + n, std::memory_order_release);
+    }
+
+    /* Samples written and not yet read, for the consumer */
+    Region readable() {
+        size_t at = readPosition.load(std::memory_order_relaxed);
+        size_t limit = writePosition.load(std::memory_order_acquire);
+        return region(at, limit - at);
+    }
+
+    /* Hand the first n samples of readable() back to the producer */
+    void commitRead(size_t n) {
+        size_t at = readPosition.load(std::memory_order_relaxed);
+        readPosition.store(at + n, std::memory_order_release);
+    }
+
+    /* Copy as much of x as fits, returning how much did */
+    template <typename T>
+    size_t write(const T &x) {
+        Region r = writable();
+        size_t n = std::min(x.size(), r.size());
+        size_t split = std::min(n, r.first.size());
+        auto it = x.begin();
+        std::copy(it, it + split, r.first.begin());
+        std::copy(it + split, it + n, r.second.begin());
+        commitWrite(n);
+        return n;
+    }
+
+    /* Copy out as much as dst holds, returning how much was read */
+    template <typename T>
+    size_t read(T &dst) {
+        Region r = readable();
+        size_t n = std::min(dst.size(), r.size());
+        size_t split = std::min(n, r.first.size());
+        auto it = dst.begin();
+        std::copy(r.first.begin(), r.first.begin() + split, it);
+        std::copy(r.second.begin(), r.second.begin() + (n - split),
+                  it + split);
+        commitRead(n);
+        return n;
+    }
+
+private:
+    Region region(size_t at, size_t n) const {
+        size_t start = at & mask;
+        size_t first = std::min(n, length - start);
+        Region r;
+        r.first = BasicSpan<F>(data + start, first);
+        r.second = BasicSpan<F>(data, n - first);
+        return r;
+    }
+
+    size_t length;
+    size_t mask;
+    unsigned char *base;
+    F *data;
+
+    /* Each side's position on a line of its own */
+    char padding0[detail::cacheLine];
+    std::atomic<size_t> writePosition;
+    char padding1[detail::cacheLine];
+    std::atomic<size_t> readPosition;
+    char padding2[detail::cacheLine];
+};
+
+typedef BasicRing<float> Ring;
+typedef BasicRing<double> DoubleRing;
+
+/* Multiple producer, multiple consumer queue of blocks, e.g. for many
+ * workers feeding one mixer.  A producer claims an empty block, fills it
+ * in place and publishes it; a consumer claims the oldest published block,
+ * uses it in place and releases it.  Claims are lock-free: a thread only
+ * retries when another thread claimed the same block first.  Blocks are
+ * published in the order they were claimed, so a slow producer holds up
+ * the blocks claimed after its own. */
+template <typename F>
+class BasicBlockQueue {
+public:
+    /* A claimed block, which is empty if none was free.  A claimed block
+     * may still hold no samples, when published with a length of zero, and
+     * must be released like any other */
+    struct Block {
+        BasicSpan<F> span;
+        size_t ticket;
+
+        Block() : ticket(detail::noTicket) {}
+
+        bool empty() const { return ticket == detail::noTicket; }
+    };
+
+    BasicBlockQueue(size_t blockSize, size_t blocks) :
+            size(blockSize), count(detail::powerOfTwo(blocks)),
+            mask(count - 1),
+            stride(detail::roundToLine(blockSize * sizeof(F))),
+            base(detail::alignedAlloc(stride * count)),
+            cells(new Cell[count]), writeTicket(0), readTicket(0) {
+        for (size_t i = 0; i < count; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+            cells[i].length = 0;
+        }
+    }
+
+    ~BasicBlockQueue() { detail::alignedFree(base); }
+
+    BasicBlockQueue(const BasicBlockQueue &) = delete;
+    BasicBlockQueue &operator=(const BasicBlockQueue &) = delete;
+
+    size_t blockSize() const { return size; }
+    size_t numBlocks() const { return count; }
+
+    /* An empty block of blockSize() samples to fill */
+    Block claimWrite() {
+        size_t ticket = claim(writeTicket, 0);
+        return block(ticket, ticket == detail::noTicket ? 0 : size);
+    }
+
+    /* Publish a block from claimWrite() holding length samples */
+    void publish(const Block &b, size_t length) {
+        Cell &cell = cells[b.ticket & mask];
+        cell.length = std::min(length, size);
+        cell.sequence.store(b.ticket + 1, std::memory_order_release);
+    }
+
+    /* The oldest published block, with the length it was published with */
+    Block claimRead() {
+        size_t ticket = claim(readTicket, 1);
+        if (ticket == detail::noTicket) {
+            return block(ticket, 0);
+        }
+        return block(ticket, cells[ticket & mask].length);
+    }
+
+    /* Give a block from claimRead() back to the producers */
+    void release(const Block &b) {
+        cells[b.ticket & mask].sequence.store(b.ticket + count,
+                                              std::memory_order_release);
+    }
+
+private:
+    /* A block is free for ticket t when its sequence is t, and published
+     * for it when its sequence is t + 1 */
+    struct Cell {
+        std::atomic<size_t> sequence;
+        size_t length;
+        char padding[detail::cacheLine];
+    };
+
+    size_t claim(std::atomic<size_t> &next, size_t offset) {
+        size_t ticket = next.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells[ticket & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            ptrdiff_t diff = (ptrdiff_t) (sequence - (ticket + offset));
+            if (diff == 0) {
+                if (next.compare_exchange_weak(ticket, ticket + 1,
+                                               std::memory_order_relaxed)) {
+                    return ticket;
+                }
+            }
+            else if (diff < 0) {
+                return detail::noTicket;
+            }
+            else {
+                ticket = next.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Block block(size_t ticket, size_t length) const {
+        Block b;
+        b.ticket = ticket;
+        if (ticket != detail::noTicket) {
+            F *p = reinterpret_cast<F *>(base + (ticket & mask) * stride);
+            b.span = BasicSpan<F>(p, length);
+        }
+        return b;
+    }
+
+    size_t size;
+    size_t count;
+    size_t mask;
+    size_t stride;
+    unsigned char *base;
+    std::unique_ptr<Cell[]> cells;
+
+    char padding0[detail::cacheLine];
+    std::atomic<size_t> writeTicket;
+    char padding1[detail::cacheLine];
+    std::atomic<size_t> readTicket;
+    char padding2[detail::cacheLine];
+};
+
+typedef BasicBlockQueue<float> BlockQueue;
+typedef BasicBlockQueue<double> DoubleBlockQueue;
+
+}
+
+#endif
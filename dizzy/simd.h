@@ -0,0 +1,862 @@
+#ifndef dizzy_simd_HPP
+#define dizzy_simd_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if !defined(DIZZY_NO_SIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define DIZZY_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#define DIZZY_PRAGMA(x) _Pragma(#x)
+
+#if defined(__clang__)
+#define DIZZY_TARGET_BEGIN(isa) \
+    DIZZY_PRAGMA(clang attribute push(__attribute__((target(isa))), \
+                                      apply_to = function))
+#define DIZZY_TARGET_END DIZZY_PRAGMA(clang attribute pop)
+#else
+#define DIZZY_TARGET_BEGIN(isa) \
+    DIZZY_PRAGMA(GCC push_options) DIZZY_PRAGMA(GCC target(isa))
+#define DIZZY_TARGET_END DIZZY_PRAGMA(GCC pop_options)
+#endif
+
+namespace dizzy {
+
+namespace approx {
+
+/* Accuracy tiers of the polynomial approximations in dizzy::approx.  See
+ * dizzy.h for the measured error of each function at each tier. */
+enum Precision {
+    LOW,
+    MEDIUM,
+    HIGH
+};
+
+}
+
+namespace simd {
+
+/* Instruction sets the kernels are compiled for, in increasing order of
+ * preference.  The scalar kernels are plain loops which the compiler is
+ * free to auto-vectorize (e.g. for NEON). */
+enum Level {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+/* How the sample kernels treat positions outside the table: clamped to its
+ * ends, or wrapped around it.  WRAP_MASK wraps with a bitmask, for tables
+ * whose size is a power of two. */
+enum Wrap {
+    CLAMP,
+    WRAP,
+    WRAP_MASK
+};
+
+/* Double precision versions of the elementwise arithmetic kernels */
+struct DoubleKernels {
+    void (*addVS)(double *, const double *, double, size_t);
+    void (*addVV)(double *, const double *, const double *, size_t);
+    void (*subVS)(double *, const double *, double, size_t);
+    void (*subVV)(double *, const double *, const double *, size_t);
+    void (*mulVS)(double *, const double *, double, size_t);
+    void (*mulVV)(double *, const double *, const double *, size_t);
+    void (*divVS)(double *, const double *, double, size_t);
+    void (*divVV)(double *, const double *, const double *, size_t);
+    void (*maddVVS)(double *, const double *, const double *, double,
+                    size_t);
+    void (*maddVVV)(double *, const double *, const double *,
+                    const double *, size_t);
+    double (*sum)(const double *, size_t);
+    double (*dot)(const double *, const double *, size_t);
+    void (*minmax)(double *, double *, const double *, size_t);
+    size_t (*argmin)(const double *, size_t);
+    size_t (*argmax)(const double *, size_t);
+};
+
+/* Table of contiguous float kernels for one instruction set */
+struct Kernels {
+    void (*addVS)(float *, const float *, float, size_t);
+    void (*addVV)(float *, const float *, const float *, size_t);
+    void (*subVS)(float *, const float *, float, size_t);
+    void (*subVV)(float *, const float *, const float *, size_t);
+    void (*mulVS)(float *, const float *, float, size_t);
+    void (*mulVV)(float *, const float *, const float *, size_t);
+    void (*divVS)(float *, const float *, float, size_t);
+    void (*divVV)(float *, const float *, const float *, size_t);
+    void (*maddVVS)(float *, const float *, const float *, float, size_t);
+    void (*maddVVV)(float *, const float *, const float *, const float *,
+                    size_t);
+    void (*mulCplx)(float *, float *, const float *, const float *,
+                    const float *, const float *, size_t);
+    void (*maddCplx)(float *, float *, const float *, const float *,
+                     const float *, const float *, const float *,
+                     const float *, size_t);
+    void (*sin[3])(float *, const float *, size_t);
+    void (*cos[3])(float *, const float *, size_t);
+    void (*tan[3])(float *, const float *, size_t);
+    void (*exp[3])(float *, const float *, size_t);
+    void (*log[3])(float *, const float *, size_t);
+    void (*powVS[3])(float *, const float *, float, size_t);
+    void (*powVV[3])(float *, const float *, const float *, size_t);
+    void (*fftRadix2)(float *, float *, const float *, const float *, size_t,
+                      size_t);
+    void (*fftRadix4)(float *, float *, const float *, const float *, size_t,
+                      size_t);
+    void (*biquad)(float *, const float *, size_t, size_t, const float *,
+                   float *, size_t);
+    void (*random)(float *, int32_t *, size_t, float, float);
+    void (*sampleLinear[3])(float *, const float *, size_t, const float *,
+                            size_t);
+    void (*sampleCubic[3])(float *, const float *, size_t, const float *,
+                           size_t);
+    void (*pack)(float *, size_t, const float *const *, size_t, size_t);
+    void (*unpack)(float *const *, size_t, const float *, size_t, size_t);
+    void (*quantize)(int32_t *, const float *, const float *, float, float,
+                     size_t);
+    double (*sum)(const float *, size_t);
+    double (*dot)(const float *, const float *, size_t);
+    void (*minmax)(float *, float *, const float *, size_t);
+    size_t (*argmin)(const float *, size_t);
+    size_t (*argmax)(const float *, size_t);
+    void (*clamp)(float *, const float *, float, float, size_t);
+    void (*sign)(float *, const float *, size_t);
+    void (*floor)(float *, const float *, size_t);
+    void (*ceil)(float *, const float *, size_t);
+    void (*round)(float *, const float *, size_t);
+    void (*fract)(float *, const float *, size_t);
+    float (*truePeak)(const float *, const float *, size_t);
+    void (*polyphase)(float *, const float *, const size_t *,
+                      const float *const *, const float *, size_t, size_t);
+    DoubleKernels doubles;
+};
+
+/* The elementwise arithmetic kernels, compiled for one length N known at
+ * compile time, such as the size of a std::array.  They take the same
+ * arguments as the kernels in Kernels, but their length argument is
+ * ignored. */
+template <typename F>
+struct Elementwise {
+    void (*addVS)(F *, const F *, F, size_t);
+    void (*addVV)(F *, const F *, const F *, size_t);
+    void (*subVS)(F *, const F *, F, size_t);
+    void (*subVV)(F *, const F *, const F *, size_t);
+    void (*mulVS)(F *, const F *, F, size_t);
+    void (*mulVV)(F *, const F *, const F *, size_t);
+    void (*divVS)(F *, const F *, F, size_t);
+    void (*divVV)(F *, const F *, const F *, size_t);
+    void (*maddVVS)(F *, const F *, const F *, F, size_t);
+    void (*maddVVV)(F *, const F *, const F *, const F *, size_t);
+};
+
+template <size_t N>
+struct FixedKernels : Elementwise<float> {
+    Elementwise<double> doubles;
+};
+
+/* sin, cos and tan arguments at or beyond this magnitude fall back to libm,
+ * as the argument reduction loses too much precision past it */
+const float reductionLimit = 8192.0f;
+
+/* Number of interleaved generators in a random stream.  Each SIMD level
+ * steps them in groups of its width, so a seed gives the same sequence at
+ * every level. */
+const size_t randomLanes = 16;
+
+/* Shape of the polyphase interpolator of the truePeak kernel; the phases
+ * are unrolled */
+const size_t truePeakPhases = 4;
+const size_t truePeakTaps = 12;
+
+/* The polyphase kernel's filters have a multiple of this many taps, two
+ * vectors at every level */
+const size_t polyphaseAlign = 32;
+
+/* Polynomial coefficients, lowest order first */
+struct Poly {
+    const float *c;
+    size_t size;
+};
+
+/* Near-minimax fits of the remainder terms used by the approximations:
+ *   sin(r) = r + r^3 * S(r^2)            on [-pi/4, pi/4]
+ *   cos(r) = 1 - r^2 / 2 + r^4 * C(r^2)  on [-pi/4, pi/4]
+ *   exp(r) = 1 + r + r^2 * E(r)          on [-ln(2) / 2, ln(2) / 2]
+ *   log(1 + f) = f - f^2 / 2 + f^3 * L(f) on [sqrt(1/2) - 1, sqrt(2) - 1] */
+template <approx::Precision P>
+struct Coefficients;
+
+template <>
+struct Coefficients<approx::LOW> {
+    static Poly sin() {
+        static const float c[] = {-1.624278873e-01f};
+        return Poly{c, 1};
+    }
+
+    static Poly cos() {
+        static const float c[] = {4.089929536e-02f};
+        return Poly{c, 1};
+    }
+
+    static Poly exp() {
+        static const float c[] = {5.039412975e-01f, 1.666283607e-01f};
+        return Poly{c, 2};
+    }
+
+    static Poly log() {
+        static const float c[] = {3.502431512e-01f, -2.372859567e-01f};
+        return Poly{c, 2};
+    }
+};
+
+template <>
+struct Coefficients<approx::MEDIUM> {
+    static Poly sin() {
+        static const float c[] = {-1.666339040e-01f, 8.163282648e-03f};
+        return Poly{c, 2};
+    }
+
+    static Poly cos() {
+        static const float c[] = {4.166107252e-02f, -1.364871161e-03f};
+        return Poly{c, 2};
+    }
+
+    static Poly exp() {
+        static const float c[] = {5.000511408e-01f, 1.675351560e-01f,
+                                  4.127769917e-02f};
+        return Poly{c, 3};
+    }
+
+    static Poly log() {
+        static const float c[] = {3.328547180e-01f, -2.524503469e-01f,
+                                  2.177645266e-01f, -1.459214836e-01f};
+        return Poly{c, 4};
+    }
+};
+
+template <>
+struct Coefficients<approx::HIGH> {
+    static Poly sin() {
+        static const float c[] = {-1.666665524e-01f, 8.332161233e-03f,
+                                  -1.951528538e-04f};
+        return Poly{c, 3};
+    }
+
+    static Poly cos() {
+        static const float c[] = {4.166664556e-02f, -1.388731645e-03f,
+                                  2.443315316e-05f};
+        return Poly{c, 3};
+    }
+
+    static Poly exp() {
+        static const float c[] = {4.999999404e-01f, 1.666652113e-01f,
+                                  4.166838899e-02f, 8.368710987e-03f,
+                                  1.381460461e-03f};
+        return Poly{c, 5};
+    }
+
+    static Poly log() {
+        static const float c[] = {3.333390951e-01f, -2.500133812e-01f,
+                                  1.996305734e-01f, -1.657759100e-01f,
+                                  1.491484940e-01f, -1.426743716e-01f,
+                                  8.700110763e-02f};
+        return Poly{c, 7};
+    }
+};
+
+/* Single lane wrapper, used on its own by the scalar kernels and for the
+ * remainder loops of the vector kernels */
+struct Scalar {
+    typedef float Vec;
+    typedef int32_t IVec;
+    typedef bool Mask;
+    static const size_t width = 1;
+
+    static Vec load(const float *p) { return *p; }
+    static void store(float *p, Vec v) { *p = v; }
+    static IVec iload(const int32_t *p) { return *p; }
+    static void istore(int32_t *p, IVec v) { *p = v; }
+    static Vec set1(float x) { return x; }
+    static Vec add(Vec a, Vec b) { return a + b; }
+    static Vec sub(Vec a, Vec b) { return a - b; }
+    static Vec mul(Vec a, Vec b) { return a * b; }
+    static Vec div(Vec a, Vec b) { return a / b; }
+    static Vec madd(Vec a, Vec b, Vec c) { return a + b * c; }
+    static Vec min(Vec a, Vec b) { return b < a ? b : a; }
+    static Vec max(Vec a, Vec b) { return b > a ? b : a; }
+    static Vec abs(Vec a) { return std::fabs(a); }
+    static Vec floor(Vec a) { return std::floor(a); }
+    static Vec ceil(Vec a) { return std::ceil(a); }
+    static Vec trunc(Vec a) { return std::trunc(a); }
+
+    static Mask lt(Vec a, Vec b) { return a < b; }
+    static Mask le(Vec a, Vec b) { return a <= b; }
+    static Mask gt(Vec a, Vec b) { return a > b; }
+    static Mask eq(Vec a, Vec b) { return a == b; }
+    static Mask both(Mask a, Mask b) { return a && b; }
+    static Vec select(Mask m, Vec a, Vec b) { return m ? a : b; }
+    static bool any(Mask m) { return m; }
+    static bool all(Mask m) { return m; }
+
+    static IVec iset1(int32_t x) { return x; }
+    static IVec iadd(IVec a, IVec b) { return (uint32_t) a + b; }
+    static IVec isub(IVec a, IVec b) { return (uint32_t) a - b; }
+    static IVec iand(IVec a, IVec b) { return a & b; }
+    static IVec ior(IVec a, IVec b) { return a | b; }
+    static IVec ixor(IVec a, IVec b) { return a ^ b; }
+    static IVec shl(IVec a, int n) { return (uint32_t) a << n; }
+    static IVec sra(IVec a, int n) { return a >> n; }
+    static IVec srl(IVec a, int n) { return (uint32_t) a >> n; }
+    static Mask ieq(IVec a, IVec b) { return a == b; }
+    static IVec toInt(Vec a) { return (int32_t) std::nearbyint(a); }
+    static Vec toFloat(IVec a) { return (float) a; }
+
+    /* Out of range values give INT32_MIN, as on x86 */
+    static IVec truncInt(Vec a) {
+        return a > -2147483648.0f && a < 2147483648.0f ? (int32_t) a :
+               std::numeric_limits<int32_t>::min();
+    }
+    static Vec gather(const float *p, IVec i) { return p[i]; }
+
+    /* lo and hi hold the elements of a and b alternately, in memory order,
+     * and deinterleave() undoes it */
+    static void interleave(Vec a, Vec b, Vec &lo, Vec &hi) {
+        lo = a;
+        hi = b;
+    }
+    static void deinterleave(Vec lo, Vec hi, Vec &a, Vec &b) {
+        a = lo;
+        b = hi;
+    }
+
+    static IVec asInt(Vec a) {
+        IVec i;
+        std::memcpy(&i, &a, sizeof(i));
+        return i;
+    }
+
+    static Vec asFloat(IVec a) {
+        Vec f;
+        std::memcpy(&f, &a, sizeof(f));
+        return f;
+    }
+};
+
+/* Double lanes, for the kernels which have double versions.  Each
+ * instruction set defines the same operations on its vectors as D. */
+struct DoubleScalar {
+    typedef double Vec;
+    typedef bool Mask;
+    static const size_t width = 1;
+
+    static Vec load(const double *p) { return *p; }
+    static void store(double *p, Vec v) { *p = v; }
+    static Vec set1(double x) { return x; }
+    static Vec add(Vec a, Vec b) { return a + b; }
+    static Vec sub(Vec a, Vec b) { return a - b; }
+    static Vec mul(Vec a, Vec b) { return a * b; }
+    static Vec div(Vec a, Vec b) { return a / b; }
+    static Vec madd(Vec a, Vec b, Vec c) { return a + b * c; }
+
+    static Mask lt(Vec a, Vec b) { return a < b; }
+    static Mask gt(Vec a, Vec b) { return a > b; }
+    static Vec select(Mask m, Vec a, Vec b) { return m ? a : b; }
+};
+
+namespace scalar {
+typedef Scalar V;
+typedef DoubleScalar D;
+namespace narrower = scalar;
+#include "kernels.inc"
+}
+
+#ifdef DIZZY_SIMD_X86
+
+DIZZY_TARGET_BEGIN("sse2")
+namespace sse2 {
+struct V {
+    typedef __m128 Vec;
+    typedef __m128i IVec;
+    typedef __m128 Mask;
+    static const size_t width = 4;
+
+    static Vec load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, Vec v) { _mm_storeu_ps(p, v); }
+    static IVec iload(const int32_t *p) {
+        return _mm_loadu_si128((const __m128i *) p);
+    }
+    static void istore(int32_t *p, IVec v) {
+        _mm_storeu_si128((__m128i *) p, v);
+    }
+    static Vec set1(float x) { return _mm_set1_ps(x); }
+    static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+    static Vec madd(Vec a, Vec b, Vec c) {
+        return _mm_add_ps(a, _mm_mul_ps(b, c));
+    }
+    static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+    static Vec abs(Vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+    /* No rounding instructions before SSE4.1, so round through int32 and
+     * correct by one where truncation went the wrong way */
+    static Vec floor(Vec a) {
+        Vec t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        Vec one = _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f));
+        return integral(a, _mm_sub_ps(t, one));
+    }
+    static Vec ceil(Vec a) {
+        Vec t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        Vec one = _mm_and_ps(_mm_cmplt_ps(t, a), _mm_set1_ps(1.0f));
+        return integral(a, _mm_add_ps(t, one));
+    }
+    static Vec trunc(Vec a) {
+        return integral(a, _mm_cvtepi32_ps(_mm_cvttps_epi32(a)));
+    }
+
+    /* The rounded value t with the sign of a, so zeros keep their sign,
+     * or a itself when it is NaN or too large to have a fraction */
+    static Vec integral(Vec a, Vec t) {
+        Vec sign = _mm_set1_ps(-0.0f);
+        t = _mm_or_ps(_mm_andnot_ps(sign, t), _mm_and_ps(sign, a));
+        Mask small = _mm_cmplt_ps(_mm_andnot_ps(sign, a),
+                                  _mm_set1_ps(8388608.0f));
+        return select(small, t, a);
+    }
+
+    static Mask lt(Vec a, Vec b) { return _mm_cmplt_ps(a, b); }
+    static Mask le(Vec a, Vec b) { return _mm_cmple_ps(a, b); }
+    static Mask gt(Vec a, Vec b) { return _mm_cmpgt_ps(a, b); }
+    static Mask eq(Vec a, Vec b) { return _mm_cmpeq_ps(a, b); }
+    static Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static Vec select(Mask m, Vec a, Vec b) {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+    static bool any(Mask m) { return _mm_movemask_ps(m) != 0; }
+    static bool all(Mask m) { return _mm_movemask_ps(m) == 0xf; }
+
+    static IVec iset1(int32_t x) { return _mm_set1_epi32(x); }
+    static IVec iadd(IVec a, IVec b) { return _mm_add_epi32(a, b); }
+    static IVec isub(IVec a, IVec b) { return _mm_sub_epi32(a, b); }
+    static IVec iand(IVec a, IVec b) { return _mm_and_si128(a, b); }
+    static IVec ior(IVec a, IVec b) { return _mm_or_si128(a, b); }
+    static IVec ixor(IVec a, IVec b) { return _mm_xor_si128(a, b); }
+    static IVec shl(IVec a, int n) {
+        return _mm_sll_epi32(a, _mm_cvtsi32_si128(n));
+    }
+    static IVec sra(IVec a, int n) {
+        return _mm_sra_epi32(a, _mm_cvtsi32_si128(n));
+    }
+    static IVec srl(IVec a, int n) {
+        return _mm_srl_epi32(a, _mm_cvtsi32_si128(n));
+    }
+    static Mask ieq(IVec a, IVec b) {
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b));
+    }
+    static IVec toInt(Vec a) { return _mm_cvtps_epi32(a); }
+    static Vec toFloat(IVec a) { return _mm_cvtepi32_ps(a); }
+    static IVec truncInt(Vec a) { return _mm_cvttps_epi32(a); }
+
+    /* No gather instruction before AVX2 */
+    static Vec gather(const float *p, IVec i) {
+        int32_t j[4];
+        _mm_storeu_si128((__m128i *) j, i);
+        return _mm_setr_ps(p[j[0]], p[j[1]], p[j[2]], p[j[3]]);
+    }
+
+    static void interleave(Vec a, Vec b, Vec &lo, Vec &hi) {
+        lo = _mm_unpacklo_ps(a, b);
+        hi = _mm_unpackhi_ps(a, b);
+    }
+    static void deinterleave(Vec lo, Vec hi, Vec &a, Vec &b) {
+        a = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        b = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    static IVec asInt(Vec a) { return _mm_castps_si128(a); }
+    static Vec asFloat(IVec a) { return _mm_castsi128_ps(a); }
+};
+
+struct D {
+    typedef __m128d Vec;
+    typedef __m128d Mask;
+    static const size_t width = 2;
+
+    static Vec load(const double *p) { return _mm_loadu_pd(p); }
+    static void store(double *p, Vec v) { _mm_storeu_pd(p, v); }
+    static Vec set1(double x) { return _mm_set1_pd(x); }
+    static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm_div_pd(a, b); }
+    static Vec madd(Vec a, Vec b, Vec c) {
+        return _mm_add_pd(a, _mm_mul_pd(b, c));
+    }
+
+    static Mask lt(Vec a, Vec b) { return _mm_cmplt_pd(a, b); }
+    static Mask gt(Vec a, Vec b) { return _mm_cmpgt_pd(a, b); }
+    static Vec select(Mask m, Vec a, Vec b) {
+        return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+    }
+};
+namespace narrower = scalar;
+#include "kernels.inc"
+}
+DIZZY_TARGET_END
+
+DIZZY_TARGET_BEGIN("avx2,fma")
+namespace avx2 {
+struct V {
+    typedef __m256 Vec;
+    typedef __m256i IVec;
+    typedef __m256 Mask;
+    static const size_t width = 8;
+
+    static Vec load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, Vec v) { _mm256_storeu_ps(p, v); }
+    static IVec iload(const int32_t *p) {
+        return _mm256_loadu_si256((const __m256i *) p);
+    }
+    static void istore(int32_t *p, IVec v) {
+        _mm256_storeu_si256((__m256i *) p, v);
+    }
+    static Vec set1(float x) { return _mm256_set1_ps(x); }
+    static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+    static Vec madd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(b, c, a); }
+    static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+    static Vec abs(Vec a) {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+    }
+    static Vec floor(Vec a) {
+        return _mm256_round_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+    static Vec ceil(Vec a) {
+        return _mm256_round_ps(a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+    }
+    static Vec trunc(Vec a) {
+        return _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    }
+
+    static Mask lt(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static Mask le(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static Mask gt(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Mask eq(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    static Vec select(Mask m, Vec a, Vec b) {
+        return _mm256_blendv_ps(b, a, m);
+    }
+    static bool any(Mask m) { return _mm256_movemask_ps(m) != 0; }
+    static bool all(Mask m) { return _mm256_movemask_ps(m) == 0xff; }
+
+    static IVec iset1(int32_t x) { return _mm256_set1_epi32(x); }
+    static IVec iadd(IVec a, IVec b) { return _mm256_add_epi32(a, b); }
+    static IVec isub(IVec a, IVec b) { return _mm256_sub_epi32(a, b); }
+    static IVec iand(IVec a, IVec b) { return _mm256_and_si256(a, b); }
+    static IVec ior(IVec a, IVec b) { return _mm256_or_si256(a, b); }
+    static IVec ixor(IVec a, IVec b) { return _mm256_xor_si256(a, b); }
+    static IVec shl(IVec a, int n) {
+        return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n));
+    }
+    static IVec sra(IVec a, int n) {
+        return _mm256_sra_epi32(a, _mm_cvtsi32_si128(n));
+    }
+    static IVec srl(IVec a, int n) {
+        return _mm256_srl_epi32(a, _mm_cvtsi32_si128(n));
+    }
+    static Mask ieq(IVec a, IVec b) {
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b));
+    }
+    static IVec toInt(Vec a) { return _mm256_cvtps_epi32(a); }
+    static Vec toFloat(IVec a) { return _mm256_cvtepi32_ps(a); }
+    static IVec truncInt(Vec a) { return _mm256_cvttps_epi32(a); }
+    static Vec gather(const float *p, IVec i) {
+        return _mm256_i32gather_ps(p, i, 4);
+    }
+
+    /* The unpacks and shuffles work within 128 bit halves, which the
+     * permutes put in order */
+    static void interleave(Vec a, Vec b, Vec &lo, Vec &hi) {
+        Vec l = _mm256_unpacklo_ps(a, b);
+        Vec h = _mm256_unpackhi_ps(a, b);
+        lo = _mm256_permute2f128_ps(l, h, 0x20);
+        hi = _mm256_permute2f128_ps(l, h, 0x31);
+    }
+    static void deinterleave(Vec lo, Vec hi, Vec &a, Vec &b) {
+        Vec l = _mm256_permute2f128_ps(lo, hi, 0x20);
+        Vec h = _mm256_permute2f128_ps(lo, hi, 0x31);
+        a = _mm256_shuffle_ps(l, h, _MM_SHUFFLE(2, 0, 2, 0));
+        b = _mm256_shuffle_ps(l, h, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    static IVec asInt(Vec a) { return _mm256_castps_si256(a); }
+    static Vec asFloat(IVec a) { return _mm256_castsi256_ps(a); }
+};
+
+struct D {
+    typedef __m256d Vec;
+    typedef __m256d Mask;
+    static const size_t width = 4;
+
+    static Vec load(const double *p) { return _mm256_loadu_pd(p); }
+    static void store(double *p, Vec v) { _mm256_storeu_pd(p, v); }
+    static Vec set1(double x) { return _mm256_set1_pd(x); }
+    static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+    static Vec madd(Vec a, Vec b, Vec c) { return _mm256_fmadd_pd(b, c, a); }
+
+    static Mask lt(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static Mask gt(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static Vec select(Mask m, Vec a, Vec b) {
+        return _mm256_blendv_pd(b, a, m);
+    }
+};
+namespace narrower = sse2;
+#include "kernels.inc"
+}
+DIZZY_TARGET_END
+
+DIZZY_TARGET_BEGIN("avx512f")
+namespace avx512 {
+/* The zero-masked forms of some intrinsics are used below as the unmasked
+ * ones trip GCC 12's uninitialized warnings on their undefined passthrough
+ * operand */
+struct V {
+    typedef __m512 Vec;
+    typedef __m512i IVec;
+    typedef __mmask16 Mask;
+    static const size_t width = 16;
+
+    static Vec load(const float *p) { return _mm512_loadu_ps(p); }
+    static void store(float *p, Vec v) { _mm512_storeu_ps(p, v); }
+    static IVec iload(const int32_t *p) { return _mm512_loadu_si512(p); }
+    static void istore(int32_t *p, IVec v) { _mm512_storeu_si512(p, v); }
+    static Vec set1(float x) { return _mm512_set1_ps(x); }
+    static Vec add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm512_div_ps(a, b); }
+    static Vec madd(Vec a, Vec b, Vec c) { return _mm512_fmadd_ps(b, c, a); }
+    static Vec min(Vec a, Vec b) { return _mm512_maskz_min_ps(0xffff, a, b); }
+    static Vec max(Vec a, Vec b) { return _mm512_maskz_max_ps(0xffff, a, b); }
+    static Vec abs(Vec a) { return _mm512_abs_ps(a); }
+    static Vec floor(Vec a) {
+        return _mm512_maskz_roundscale_ps(
+                0xffff, a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+    static Vec ceil(Vec a) {
+        return _mm512_maskz_roundscale_ps(
+                0xffff, a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+    }
+    static Vec trunc(Vec a) {
+        return _mm512_maskz_roundscale_ps(
+                0xffff, a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    }
+
+    static Mask lt(Vec a, Vec b) {
+        return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+    }
+    static Mask le(Vec a, Vec b) {
+        return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ);
+    }
+    static Mask gt(Vec a, Vec b) {
+        return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ);
+    }
+    static Mask eq(Vec a, Vec b) {
+        return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+    }
+    static Mask both(Mask a, Mask b) { return a & b; }
+    static Vec select(Mask m, Vec a, Vec b) {
+        return _mm512_mask_blend_ps(m, b, a);
+    }
+    static bool any(Mask m) { return m != 0; }
+    static bool all(Mask m) { return m == 0xffff; }
+
+    static IVec iset1(int32_t x) { return _mm512_set1_epi32(x); }
+    static IVec iadd(IVec a, IVec b) { return _mm512_add_epi32(a, b); }
+    static IVec isub(IVec a, IVec b) { return _mm512_sub_epi32(a, b); }
+    static IVec iand(IVec a, IVec b) { return _mm512_and_epi32(a, b); }
+    static IVec ior(IVec a, IVec b) { return _mm512_or_epi32(a, b); }
+    static IVec ixor(IVec a, IVec b) { return _mm512_xor_epi32(a, b); }
+    static IVec shl(IVec a, int n) {
+        return _mm512_maskz_sll_epi32(0xffff, a, _mm_cvtsi32_si128(n));
+    }
+    static IVec sra(IVec a, int n) {
+        return _mm512_maskz_sra_epi32(0xffff, a, _mm_cvtsi32_si128(n));
+    }
+    static IVec srl(IVec a, int n) {
+        return _mm512_maskz_srl_epi32(0xffff, a, _mm_cvtsi32_si128(n));
+    }
+    static Mask ieq(IVec a, IVec b) { return _mm512_cmpeq_epi32_mask(a, b); }
+    static IVec toInt(Vec a) { return _mm512_maskz_cvtps_epi32(0xffff, a); }
+    static Vec toFloat(IVec a) { return _mm512_maskz_cvtepi32_ps(0xffff, a); }
+    static IVec truncInt(Vec a) {
+        return _mm512_maskz_cvttps_epi32(0xffff, a);
+    }
+    static Vec gather(const float *p, IVec i) {
+        return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, i, p,
+                                        4);
+    }
+
+    static void interleave(Vec a, Vec b, Vec &lo, Vec &hi) {
+        lo = _mm512_permutex2var_ps(a, _mm512_setr_epi32(
+            0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23), b);
+        hi = _mm512_permutex2var_ps(a, _mm512_setr_epi32(
+            8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31), b);
+    }
+    static void deinterleave(Vec lo, Vec hi, Vec &a, Vec &b) {
+        a = _mm512_permutex2var_ps(lo, _mm512_setr_epi32(
+            0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30), hi);
+        b = _mm512_permutex2var_ps(lo, _mm512_setr_epi32(
+            1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31), hi);
+    }
+    static IVec asInt(Vec a) { return _mm512_castps_si512(a); }
+    static Vec asFloat(IVec a) { return _mm512_castsi512_ps(a); }
+};
+
+struct D {
+    typedef __m512d Vec;
+    typedef __mmask8 Mask;
+    static const size_t width = 8;
+
+    static Vec load(const double *p) { return _mm512_loadu_pd(p); }
+    static void store(double *p, Vec v) { _mm512_storeu_pd(p, v); }
+    static Vec set1(double x) { return _mm512_set1_pd(x); }
+    static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm512_div_pd(a, b); }
+    static Vec madd(Vec a, Vec b, Vec c) { return _mm512_fmadd_pd(b, c, a); }
+
+    static Mask lt(Vec a, Vec b) {
+        return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);
+    }
+    static Mask gt(Vec a, Vec b) {
+        return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ);
+    }
+    static Vec select(Mask m, Vec a, Vec b) {
+        return _mm512_mask_blend_pd(m, b, a);
+    }
+};
+namespace narrower = avx2;
+#include "kernels.inc"
+}
+DIZZY_TARGET_END
+
+#endif
+
+/* Best instruction set supported by the CPU we are running on */
+inline Level detect() {
+#ifdef DIZZY_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SSE2;
+    }
+#endif
+    return SCALAR;
+}
+
+inline Kernels select(Level level) {
+    Kernels kernels;
+    switch (level) {
+#ifdef DIZZY_SIMD_X86
+        case AVX512:
+            avx512::fill(kernels);
+            break;
+        case AVX2:
+            avx2::fill(kernels);
+            break;
+        case SSE2:
+            sse2::fill(kernels);
+            break;
+#endif
+        default:
+            scalar::fill(kernels);
+            break;
+    }
+    return kernels;
+}
+
+template <size_t N>
+FixedKernels<N> selectFixed(Level level) {
+    FixedKernels<N> kernels;
+    switch (level) {
+#ifdef DIZZY_SIMD_X86
+        case AVX512:
+            avx512::fillFixed(kernels);
+            break;
+        case AVX2:
+            avx2::fillFixed(kernels);
+            break;
+        case SSE2:
+            sse2::fillFixed(kernels);
+            break;
+#endif
+        default:
+            scalar::fillFixed(kernels);
+            break;
+    }
+    return kernels;
+}
+
+inline Level &currentLevel() {
+    static Level level = detect();
+    return level;
+}
+
+inline Kernels &kernels() {
+    static Kernels k = select(currentLevel());
+    return k;
+}
+
+inline Level level() {
+    return currentLevel();
+}
+
+/* Fixed length kernels for the current level.  Each length has a table
+ * per level, made on first use, so setLevel() applies to them too. */
+template <size_t N>
+const FixedKernels<N> &fixedKernels() {
+    static const FixedKernels<N> tables[] = {
+        selectFixed<N>(SCALAR), selectFixed<N>(SSE2), selectFixed<N>(AVX2),
+        selectFixed<N>(AVX512)
+    };
+    return tables[currentLevel()];
+}
+
+/* Force a lower instruction set, e.g. for testing or benchmarking.  Levels
+ * above what the CPU supports are clamped.  Not safe to call while other
+ * threads are running dizzy functions. */
+inline void setLevel(Level level) {
+    Level supported = detect();
+    if (level > supported) {
+        level = supported;
+    }
+    currentLevel() = level;
+    kernels() = select(level);
+}
+
+}
+}
+
+#endif
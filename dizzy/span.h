@@ -0,0 +1,164 @@
+#ifndef dizzy_span_HPP
+#define dizzy_span_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace dizzy {
+
+/* Non-owning views of memory owned elsewhere, such as driver buffers,
+ * mmap'd files or sub-ranges of larger blocks, which can be passed to any
+ * dizzy function in place of a container.
+ *
+ * Like std::span the views are shallow: a const view still gives mutable
+ * access to the elements, so read-only memory has to be const_cast to
+ * build one.  dizzy never writes through its const parameters. */
+
+/* Contiguous pointer and length.  Float and double spans take the same SIMD
+ * paths as std::vector<float> and std::vector<double>. */
+template <typename F>
+class BasicSpan {
+public:
+    typedef F value_type;
+    typedef F &reference;
+    typedef const F &const_reference;
+    typedef F *iterator;
+    typedef F *const_iterator;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    BasicSpan() : x(NULL), length(0) {}
+    BasicSpan(F *data, size_t size) : x(data), length(size) {}
+    BasicSpan(F *first, F *last) : x(first), length(last - first) {}
+
+    /* View a whole container which stores its elements contiguously */
+    template <typename C>
+    explicit BasicSpan(C &c) : x(c.data()), length(c.size()) {}
+
+    F *data() const { return x; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    F *begin() const { return x; }
+    F *end() const { return x + length; }
+    F &operator[](size_t i) const { return x[i]; }
+
+    /* Count elements starting at offset, clipped to the end of the view */
+    BasicSpan subspan(size_t offset, size_t count=size_t(-1)) const {
+        offset = offset < length ? offset : length;
+        count = count < length - offset ? count : length - offset;
+        return BasicSpan(x + offset, count);
+    }
+
+private:
+    F *x;
+    size_t length;
+};
+
+template <typename F>
+class StrideIterator {
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef F value_type;
+    typedef ptrdiff_t difference_type;
+    typedef F *pointer;
+    typedef F &reference;
+
+    StrideIterator() : x(NULL), stride(1) {}
+    StrideIterator(F *x, ptrdiff_t stride) : x(x), stride(stride) {}
+
+    F &operator*() const { return *x; }
+    F *operator->() const { return x; }
+    F &operator[](ptrdiff_t i) const { return x[i * stride]; }
+
+    StrideIterator &operator++() { x += stride; return *this; }
+    StrideIterator &operator--() { x -= stride; return *this; }
+    StrideIterator operator++(int) {
+        StrideIterator it = *this;
+        x += stride;
+        return it;
+    }
+    StrideIterator operator--(int) {
+        StrideIterator it = *this;
+        x -= stride;
+        return it;
+    }
+
+    StrideIterator &operator+=(ptrdiff_t n) { x += n * stride; return *this; }
+    StrideIterator &operator-=(ptrdiff_t n) { x -= n * stride; return *this; }
+    StrideIterator operator+(ptrdiff_t n) const {
+        return StrideIterator(x + n * stride, stride);
+    }
+    StrideIterator operator-(ptrdiff_t n) const {
+        return StrideIterator(x - n * stride, stride);
+    }
+    friend StrideIterator operator+(ptrdiff_t n, const StrideIterator &it) {
+        return it + n;
+    }
+    ptrdiff_t operator-(const StrideIterator &it) const {
+        return (x - it.x) / stride;
+    }
+
+    bool operator==(const StrideIterator &it) const { return x == it.x; }
+    bool operator!=(const StrideIterator &it) const { return x != it.x; }
+    bool operator<(const StrideIterator &it) const {
+        return stride > 0 ? x < it.x : x > it.x;
+    }
+    bool operator>(const StrideIterator &it) const { return it < *this; }
+    bool operator<=(const StrideIterator &it) const { return !(it < *this); }
+    bool operator>=(const StrideIterator &it) const { return !(*this < it); }
+
+private:
+    F *x;
+    ptrdiff_t stride;
+};
+
+/* Every stride'th element, e.g. one channel of an interleaved buffer:
+ *
+ *     dizzy::StridedSpan left(frames, numFrames, 2);
+ *     dizzy::StridedSpan right(frames + 1, numFrames, 2);
+ */
+template <typename F>
+class BasicStridedSpan {
+public:
+    typedef F value_type;
+    typedef F &reference;
+    typedef const F &const_reference;
+    typedef StrideIterator<F> iterator;
+    typedef StrideIterator<F> const_iterator;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    BasicStridedSpan() : x(NULL), length(0), step(1) {}
+    BasicStridedSpan(F *data, size_t size, ptrdiff_t stride) :
+        x(data), length(size), step(stride) {}
+
+    F *data() const { return x; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    ptrdiff_t stride() const { return step; }
+
+    iterator begin() const { return iterator(x, step); }
+    iterator end() const { return iterator(x + length * step, step); }
+    F &operator[](size_t i) const { return x[i * step]; }
+
+    BasicStridedSpan subspan(size_t offset, size_t count=size_t(-1)) const {
+        offset = offset < length ? offset : length;
+        count = count < length - offset ? count : length - offset;
+        return BasicStridedSpan(x + offset * step, count, step);
+    }
+
+private:
+    F *x;
+    size_t length;
+    ptrdiff_t step;
+};
+
+typedef BasicSpan<float> Span;
+typedef BasicStridedSpan<float> StridedSpan;
+typedef BasicSpan<double> DoubleSpan;
+typedef BasicStridedSpan<double> DoubleStridedSpan;
+
+}
+
+#endif
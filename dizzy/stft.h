@@ -0,0 +1,159 @@
+#ifndef dizzy_stft_HPP
+#define dizzy_stft_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "dizzy.h"
+#include "dizzy/fft.h"
+#include "dizzy/window.h"
+
+namespace dizzy {
+
+/* Streaming short-time Fourier transform.  Every hop samples the last
+ * frameSize samples of input are windowed and transformed, and the
+ * spectrum is handed to a callback as split real and imaginary spans of
+ * frameSize / 2 + 1 bins, the layout mulCplx and friends take.  The
+ * callback may change the spectrum in place; process() then transforms it
+ * back and overlap-adds it into the output:
+ *
+ *     dizzy::STFT stft(1024, 256, [&](dizzy::Span re, dizzy::Span im) {
+ *         dizzy::mul(re, re, gains);
+ *         dizzy::mul(im, im, gains);
+ *     });
+ *     stft.process(out, in);     // any number of samples per call
+ *
+ * The resynthesis window is the analysis window divided by the sum of the
+ * squared analysis windows overlapping each sample, so an untouched
+ * spectrum gives back the input exactly, delayed by latency() samples, for
+ * any window and hop whose overlapping windows cover every sample.  The
+ * window is one of the cached Window tables, by default a periodic Hann
+ * window, which needs a hop of at most half the frame, or any other table
+ * of frameSize samples.  analyze() runs the callbacks only, e.g. for
+ * metering.
+ *
+ * All frame storage is allocated on construction. */
+class STFT {
+public:
+    typedef std::function<void(Span real, Span imag)> Function;
+
+    STFT(size_t frameSize, size_t hop, Function function,
+         Window::Type window=Window::HANN) :
+            STFT(Window::get(window, std::max(frameSize, (size_t) 1))
+                         ->coefficients(),
+                 hop, function) {}
+
+    STFT(const std::vector<float> &window, size_t hop, Function function) :
+            length(std::max(window.size(), (size_t) 1)),
+            step(std::min(std::max(hop, (size_t) 1), length)),
+            function(function), fft(length), analysis(length, 0.0f),
+            synthesis(length), input(length, 0.0f), frame(length),
+            overlap(length, 0.0f), ready(step, 0.0f), re(length / 2 + 1),
+            im(length / 2 + 1), position(0) {
+        std::copy(window.begin(), window.end(), analysis.begin());
+
+        std::vector<double> sums(step, 0.0);
+        for (size_t i = 0; i < length; i++) {
+            sums[i % step] += (double) analysis[i] * analysis[i];
+        }
+        for (size_t i = 0; i < length; i++) {
+            double sum = sums[i % step];
+            synthesis[i] = sum > 0.0 ? analysis[i] / sum : 0.0f;
+        }
+    }
+
+    size_t frameSize() const { return length; }
+    size_t hop() const { return step; }
+    size_t bins() const { return re.size(); }
+
+    /* Delay of the output relative to the input, in samples */
+    size_t latency() const { return length; }
+
+    template <typename T>
+    void process(T &dst, const T &x) {
+        size_t n = std::min(dst.size(), x.size());
+        auto dstIt = dst.begin();
+        auto xIt = x.begin();
+        for (size_t i = 0; i < n;) {
+            size_t chunk = std::min(n - i, step - position);
+            std::copy(xIt, xIt + chunk,
+                      input.begin() + (length - step) + position);
+            std::copy(ready.begin() + position,
+                      ready.begin() + position + chunk, dstIt);
+            advance(chunk, true);
+            i += chunk;
+            xIt += chunk;
+            dstIt += chunk;
+        }
+    }
+
+    template <typename T>
+    void analyze(const T &x) {
+        size_t n = x.size();
+        auto xIt = x.begin();
+        for (size_t i = 0; i < n;) {
+            size_t chunk = std::min(n - i, step - position);
+            std::copy(xIt, xIt + chunk,
+                      input.begin() + (length - step) + position);
+            advance(chunk, false);
+            i += chunk;
+            xIt += chunk;
+        }
+    }
+
+    /* Clear the input and output history, e.g. when the stream restarts */
+    void reset() {
+        std::fill(input.begin(), input.end(), 0.0f);
+        std::fill(overlap.begin(), overlap.end(), 0.0f);
+        std::fill(ready.begin(), ready.end(), 0.0f);
+        position = 0;
+    }
+
+private:
+    void advance(size_t chunk, bool resynthesize) {
+        position += chunk;
+        if (position < step) {
+            return;
+        }
+        position = 0;
+
+        mul(frame, input, analysis);
+        fft.forward(re, im, frame);
+        Span spanRe(re), spanIm(im);
+        function(spanRe, spanIm);
+        std::copy(input.begin() + step, input.end(), input.begin());
+
+        if (resynthesize) {
+            /* The first hop samples of the overlap now have every frame
+             * covering them added */
+            fft.inverse(frame, re, im);
+            madd(overlap, overlap, frame, synthesis);
+            std::copy(overlap.begin(), overlap.begin() + step,
+                      ready.begin());
+            std::copy(overlap.begin() + step, overlap.end(),
+                      overlap.begin());
+            std::fill(overlap.end() - step, overlap.end(), 0.0f);
+        }
+    }
+
+    size_t length;
+    size_t step;
+    Function function;
+    FFT fft;
+    std::vector<float> analysis, synthesis;
+
+    /* The last frameSize samples of input, the newest hop of them still
+     * being filled, and the output samples still missing frames */
+    std::vector<float> input;
+    std::vector<float> frame;
+    std::vector<float> overlap;
+    std::vector<float> ready;
+    std::vector<float> re, im;
+    size_t position;
+};
+
+}
+
+#endif
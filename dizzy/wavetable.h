@@ -0,0 +1,127 @@
+#ifndef dizzy_wavetable_HPP
+#define dizzy_wavetable_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "dizzy.h"
+#include "dizzy/fft.h"
+
+namespace dizzy {
+
+/* Mip-mapped wavetable for alias-free playback, built once from a single
+ * cycle of any length.  The cycle is resampled through its spectrum into
+ * octave spaced levels of a power of two size: level j keeps the harmonics
+ * below size / 2^(j + 1), so it cannot alias while the phase advances by at
+ * most 2^j table samples per output sample.
+ *
+ * process() reads the two levels either side of a block's phase increment
+ * with the cubic interpolation of sampleCubic, and crossfades them by the
+ * fraction of an octave, so the brightness follows a pitch sweep smoothly.
+ * Increments up to 1/2 read level 0 alone.  Phases are in table samples
+ * and wrap around the table. */
+class Wavetable {
+public:
+    template <typename T>
+    explicit Wavetable(const T &cycle, size_t size=2048) :
+            length(4), mix(256) {
+        while (length < size) {
+            length *= 2;
+        }
+
+        std::vector<float> x(cycle.begin(), cycle.end());
+        if (x.empty()) {
+            x.push_back(0.0f);
+        }
+        size_t m = x.size();
+        std::vector<float> re(m / 2 + 1), im(m / 2 + 1);
+        FFT(m).forward(re, im, x);
+
+        /* A harmonic at the cycle's own Nyquist frequency is ambiguous, so
+         * it is dropped along with everything above */
+        size_t harmonics = (m - 1) / 2;
+        float scale = (float) length / m;
+
+        FFT fft(length);
+        std::vector<float> levelRe(length / 2 + 1), levelIm(length / 2 + 1);
+        for (size_t limit = length / 2; limit >= 2; limit /= 2) {
+            std::fill(levelRe.begin(), levelRe.end(), 0.0f);
+            std::fill(levelIm.begin(), levelIm.end(), 0.0f);
+            for (size_t h = 0; h < limit && h <= harmonics; h++) {
+                levelRe[h] = re[h] * scale;
+                levelIm[h] = im[h] * scale;
+            }
+            tables.push_back(std::vector<float>(length));
+            fft.inverse(tables.back(), levelRe, levelIm);
+        }
+    }
+
+    /* Table length, and so the period of the phase */
+    size_t size() const { return length; }
+
+    size_t levels() const { return tables.size(); }
+
+    const std::vector<float> &level(size_t i) const { return tables[i]; }
+
+    /* Read the table at phase, which advances by about increment table
+     * samples per output sample over the block */
+    template <typename T>
+    void process(T &dst, const T &phase, float increment) {
+        size_t count = std::min(dst.size(), phase.size());
+
+        /* Ordered so that NaN and zero increments read level 0 */
+        float last = tables.size() - 1.0f;
+        float octave = std::log2(std::fabs(increment)) + 1.0f;
+        octave = octave > 0.0f ? std::min(octave, last) : 0.0f;
+        size_t lower = (size_t) octave;
+        float weight = octave - lower;
+
+        if (detail::Contiguous<T>::value) {
+            render(detail::data(dst), detail::data(phase), count, lower,
+                   weight);
+            return;
+        }
+
+        float in[256];
+        float out[256];
+        auto dstIt = dst.begin();
+        auto phaseIt = phase.begin();
+        for (size_t i = 0; i < count; i += 256) {
+            size_t n = std::min(count - i, (size_t) 256);
+            std::copy(phaseIt, phaseIt + n, in);
+            phaseIt += n;
+            render(out, in, n, lower, weight);
+            dstIt = std::copy(out, out + n, dstIt);
+        }
+    }
+
+private:
+    /* The upper level is read first, so dst may alias phase */
+    void render(float *dst, const float *phase, size_t count, size_t lower,
+                float weight) {
+        simd::Kernels &kernels = simd::kernels();
+        auto lookup = kernels.sampleCubic[simd::WRAP_MASK];
+        if (weight == 0.0f) {
+            lookup(dst, tables[lower].data(), length, phase, count);
+            return;
+        }
+
+        for (size_t i = 0; i < count; i += mix.size()) {
+            size_t n = std::min(count - i, mix.size());
+            lookup(mix.data(), tables[lower + 1].data(), length, phase + i,
+                   n);
+            lookup(dst + i, tables[lower].data(), length, phase + i, n);
+            kernels.subVV(mix.data(), mix.data(), dst + i, n);
+            kernels.maddVVS(dst + i, dst + i, mix.data(), weight, n);
+        }
+    }
+
+    size_t length;
+    std::vector<std::vector<float> > tables;
+    std::vector<float> mix;
+};
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef dizzy_window_HPP
+#define dizzy_window_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "dizzy.h"
+
+namespace dizzy {
+
+namespace detail {
+
+/* Zeroth order modified Bessel function of the first kind, for the Kaiser
+ * window */
+inline double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 100 && term > sum * 1e-17; k++) {
+        double half = x / (2.0 * k);
+        term *= half * half;
+        sum += term;
+    }
+    return sum;
+}
+
+}
+
+/* Table of window coefficients for one type and size.  Tables are computed
+ * once, in double, and shared by every user of the same window through
+ * get(), which may be called from any thread.  Unlike FFT plans, tables
+ * stay cached after their last user lets go, so a window fetched per frame
+ * is never recomputed:
+ *
+ *     std::shared_ptr<const dizzy::Window> hann =
+ *             dizzy::Window::get(dizzy::Window::HANN, 1024);
+ *     hann->apply(frame, input);     // frame = input * window
+ *     fft.forward(re, im, frame);
+ *
+ * PERIODIC windows, the default, are for spectral analysis: they are one
+ * sample short of a symmetric window of size + 1, so that overlapped
+ * frames sum to a constant.  SYMMETRIC windows are for filter design.  The
+ * Kaiser window takes its shape parameter beta; the other types ignore
+ * it. */
+class Window {
+public:
+    enum Type {HANN, HAMMING, BLACKMAN_HARRIS, KAISER, FLAT_TOP};
+    enum Symmetry {PERIODIC, SYMMETRIC};
+
+    Window(Type type, size_t size, Symmetry symmetry=PERIODIC,
+           double beta=8.6) : exact(size), table(size) {
+        const double pi = 3.14159265358979323846;
+        if (size == 0) {
+            return;
+        }
+
+        /* A single sample has no phase to speak of, and passes through */
+        if (size == 1) {
+            exact[0] = 1.0;
+            table[0] = 1.0f;
+            return;
+        }
+
+        /* Windows are functions of the phase across the frame */
+        size_t span = symmetry == SYMMETRIC ? size - 1 : size;
+        ramp(exact, 0.0, 2.0 * pi * (size - 1) / span);
+
+        switch (type) {
+        case HANN:
+            cosineSum({0.5, 0.5});
+            break;
+        case HAMMING:
+            cosineSum({0.54, 0.46});
+            break;
+        case BLACKMAN_HARRIS:
+            cosineSum({0.35875, 0.48829, 0.14128, 0.01168});
+            break;
+        case FLAT_TOP:
+            cosineSum({0.21557895, 0.41663158, 0.277263158, 0.083578947,
+                       0.006947368});
+            break;
+        case KAISER:
+            for (size_t i = 0; i < size; i++) {
+                double r = exact[i] / pi - 1.0;
+                double t = std::sqrt(std::max(1.0 - r * r, 0.0));
+                exact[i] = detail::besselI0(beta * t) /
+                           detail::besselI0(beta);
+            }
+            break;
+        }
+        std::copy(exact.begin(), exact.end(), table.begin());
+    }
+
+    Window(const Window &) = delete;
+    Window &operator=(const Window &) = delete;
+
+    static std::shared_ptr<const Window> get(Type type, size_t size,
+                                             Symmetry symmetry=PERIODIC,
+                                             double beta=8.6) {
+        typedef std::tuple<int, size_t, int, double> Key;
+        static std::mutex mutex;
+        static std::map<Key, std::shared_ptr<const Window> > cache;
+
+        Key key(type, size, symmetry, type == KAISER ? beta : 0.0);
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const Window> &window = cache[key];
+        if (!window) {
+            window = std::make_shared<const Window>(type, size, symmetry,
+                                                    beta);
+        }
+        return window;
+    }
+
+    size_t size() const { return table.size(); }
+
+    const std::vector<float> &coefficients() const { return table; }
+    const std::vector<double> &doubleCoefficients() const { return exact; }
+
+    /* dst = x * window, as mul() does, in the same pass as the copy out
+     * of x.  The length is the shortest of the three. */
+    template <typename T>
+    void apply(T &dst, const T &x) const {
+        size_t length = std::min(dst.size(), x.size());
+        length = std::min(length, size());
+
+        if (detail::Contiguous<T>::value) {
+            simd::kernels().mulVV(detail::data(dst), detail::data(x),
+                                  table.data(), length);
+            return;
+        }
+        if (detail::Contiguous<T, double>::value) {
+            simd::kernels().doubles.mulVV(detail::doubles(dst),
+                                          detail::doubles(x), exact.data(),
+                                          length);
+            return;
+        }
+
+        auto dstIt = dst.begin();
+        auto xIt = x.begin();
+        for (size_t i = 0; i < length; i++, dstIt++, xIt++) {
+            *dstIt = (*xIt) * (detail::Value<T>) exact[i];
+        }
+    }
+
+private:
+    /* Sum of cosines of multiples of the phase with alternating signs */
+    void cosineSum(std::initializer_list<double> terms) {
+        for (size_t i = 0; i < exact.size(); i++) {
+            double phase = exact[i], sum = 0.0, sign = 1.0;
+            size_t k = 0;
+            for (double a : terms) {
+                sum += sign * a * std::cos(k * phase);
+                sign = -sign;
+                k++;
+            }
+            exact[i] = sum;
+        }
+    }
+
+    std::vector<double> exact;
+    std::vector<float> table;
+};
+
+}
+
+#endif
@@ -1,4 +1,8 @@
 #include <limits>
+#include <deque>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -176,6 +180,258 @@ TEST(PowTest, PowDecimal) {
     EXPECT_THAT(a[3], testing::FloatEq(d[3]));
 }
 
+TEST(CplxTest, MulCplx) {
+    std::array<float, 4> aRe, aIm, bRe={1,2,-3,0.5}, bIm={0,1,2,-4}, cRe={2,-1,3,1}, cIm={1,3,-2,0.25}, dRe={2,-5,-5,1.5}, dIm={1,5,12,-3.875};
+
+    dizzy::mulCplx(aRe, aIm, bRe, bIm, cRe, cIm);
+
+    EXPECT_THAT(aRe, testing::Eq(dRe));
+    EXPECT_THAT(aIm, testing::Eq(dIm));
+}
+
+TEST(CplxTest, MaddCplx) {
+    std::vector<float> aRe(19), aIm(19), bRe(19), bIm(19), cRe(19), cIm(19),
+                       dRe(19), dIm(19);
+    for (size_t i = 0; i < aRe.size(); i++) {
+        aRe[i] = i * 0.5f;
+        aIm[i] = 1.0f - i;
+        bRe[i] = i % 3;
+        bIm[i] = 2.0f - i % 5;
+        cRe[i] = i * -0.25f;
+        cIm[i] = 1.5f;
+    }
+
+    dizzy::maddCplx(dRe, dIm, aRe, aIm, bRe, bIm, cRe, cIm);
+    dizzy::maddCplx(aRe, aIm, aRe, aIm, bRe, bIm, cRe, cIm);
+
+    for (size_t i = 0; i < dRe.size(); i++) {
+        float re = i * 0.5f + (i % 3) * (i * -0.25f) - (2.0f - i % 5) * 1.5f;
+        float im = 1.0f - i + (i % 3) * 1.5f + (2.0f - i % 5) * (i * -0.25f);
+        EXPECT_THAT(dRe[i], testing::FloatEq(re));
+        EXPECT_THAT(dIm[i], testing::FloatEq(im));
+        EXPECT_THAT(aRe[i], testing::FloatEq(re));
+        EXPECT_THAT(aIm[i], testing::FloatEq(im));
+    }
+}
+
+TEST(SimdTest, LevelsMatchReference) {
+    std::vector<float> a(37), b(37), c(37), d(37);
+    for (size_t i = 0; i < b.size(); i++) {
+        b[i] = i * 3.25f - 40.0f;
+        c[i] = i * -1.5f + 7.0f;
+        d[i] = i * 0.125f + 1.0f;
+    }
+
+    dizzy::simd::Level levels[] = {dizzy::simd::SCALAR, dizzy::simd::SSE2,
+                                   dizzy::simd::AVX2, dizzy::simd::AVX512};
+    for (dizzy::simd::Level level : levels) {
+        dizzy::simd::setLevel(level);
+
+        dizzy::add(a, b, c);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::FloatEq(b[i] + c[i]));
+        }
+
+        dizzy::sub(a, b, 2.5f);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::FloatEq(b[i] - 2.5f));
+        }
+
+        dizzy::mul(a, b, c);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::FloatEq(b[i] * c[i]));
+        }
+
+        dizzy::div(a, b, d);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::FloatEq(b[i] / d[i]));
+        }
+
+        dizzy::madd(a, b, c, d);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::FloatEq(b[i] + c[i] * d[i]));
+        }
+
+        dizzy::madd(a, b, c, 0.5f);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::FloatEq(b[i] + c[i] * 0.5f));
+        }
+    }
+
+    dizzy::simd::setLevel(dizzy::simd::detect());
+}
+
+TEST(SimdTest, InPlace) {
+    std::vector<float> a={1,2,3,4,5,6,7,8,9,10,11}, b={11,10,9,8,7,6,5,4,3,2,1};
+
+    dizzy::add(a, a, b);
+
+    EXPECT_THAT(a, testing::Each(12.0f));
+}
+
+TEST(SimdTest, ShortestLength) {
+    std::vector<float> a(5, -1.0f), b={1,2,3}, c={4,5,6,7};
+
+    dizzy::mul(a, b, c);
+
+    EXPECT_THAT(a, testing::ElementsAre(4, 10, 18, -1, -1));
+}
+
+TEST(DoubleTest, LevelsMatchReference) {
+    std::vector<double> a(37), b(37), c(37), d(37);
+    for (size_t i = 0; i < b.size(); i++) {
+        b[i] = i * 0.1 - 1.0 / 3.0;
+        c[i] = i * -1.7 + 1e-9;
+        d[i] = i * 0.3 + 1.0;
+    }
+
+    dizzy::simd::Level levels[] = {dizzy::simd::SCALAR, dizzy::simd::SSE2,
+                                   dizzy::simd::AVX2, dizzy::simd::AVX512};
+    for (dizzy::simd::Level level : levels) {
+        dizzy::simd::setLevel(level);
+
+        dizzy::add(a, b, c);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::DoubleEq(b[i] + c[i]));
+        }
+
+        dizzy::sub(a, b, 0.1);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::DoubleEq(b[i] - 0.1));
+        }
+
+        dizzy::mul(a, b, c);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::DoubleEq(b[i] * c[i]));
+        }
+
+        dizzy::div(a, b, d);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::DoubleEq(b[i] / d[i]));
+        }
+
+        dizzy::madd(a, b, c, d);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::DoubleEq(b[i] + c[i] * d[i]));
+        }
+
+        dizzy::madd(a, b, c, 0.1);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], testing::DoubleEq(b[i] + c[i] * 0.1));
+        }
+    }
+
+    dizzy::simd::setLevel(dizzy::simd::detect());
+}
+
+TEST(DoubleTest, KeepsPrecision) {
+    /* Steps far below float resolution survive the scalar argument */
+    std::vector<double> a(19), b(19, 1.0);
+    std::array<double, 19> c, d;
+    d.fill(1.0);
+    std::deque<double> e(19), f(19, 1.0);
+
+    dizzy::add(a, b, 1e-12);
+    dizzy::add(c, d, 1e-12);
+    dizzy::add(e, f, 1e-12);
+    EXPECT_THAT(a, testing::Each(1.0 + 1e-12));
+    EXPECT_THAT(c, testing::Each(1.0 + 1e-12));
+    EXPECT_THAT(e, testing::Each(1.0 + 1e-12));
+
+    dizzy::DoubleStridedSpan strided(a.data(), a.size(), 1);
+    dizzy::mul(strided, strided, 1.0 + 1e-12);
+    EXPECT_THAT(a, testing::Each((1.0 + 1e-12) * (1.0 + 1e-12)));
+
+    dizzy::ramp(a, 0.0, 1.8);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(a[i], testing::DoubleEq(i * 0.1));
+    }
+
+    dizzy::clamp(a, a, 0.1, 0.7);
+    EXPECT_THAT(a[0], testing::DoubleEq(0.1));
+    EXPECT_THAT(a[5], testing::DoubleEq(0.5));
+    EXPECT_THAT(a[18], testing::DoubleEq(0.7));
+}
+
+namespace {
+
+/* Every elementwise function on std::arrays, which take the fixed length
+ * kernels, against the same arrays viewed through spans, which do not */
+template <typename F, size_t N>
+void expectFixedMatchesSpans() {
+    std::array<F, N> a, b, c, d, e;
+    for (size_t i = 0; i < N; i++) {
+        b[i] = i * F(3.25) - F(40);
+        c[i] = i * F(-1.5) + F(7);
+        d[i] = i * F(0.125) + F(1);
+    }
+    dizzy::BasicSpan<F> as(e), bs(b), cs(c), ds(d);
+
+    dizzy::add(a, b, c);
+    dizzy::add(as, bs, cs);
+    EXPECT_EQ(a, e);
+    dizzy::add(a, b, F(0.5));
+    dizzy::add(as, bs, F(0.5));
+    EXPECT_EQ(a, e);
+    dizzy::sub(a, b, c);
+    dizzy::sub(as, bs, cs);
+    EXPECT_EQ(a, e);
+    dizzy::sub(a, b, F(2.5));
+    dizzy::sub(as, bs, F(2.5));
+    EXPECT_EQ(a, e);
+    dizzy::mul(a, b, c);
+    dizzy::mul(as, bs, cs);
+    EXPECT_EQ(a, e);
+    dizzy::mul(a, b, F(0.3));
+    dizzy::mul(as, bs, F(0.3));
+    EXPECT_EQ(a, e);
+    dizzy::div(a, b, d);
+    dizzy::div(as, bs, ds);
+    EXPECT_EQ(a, e);
+    dizzy::div(a, b, F(0.7));
+    dizzy::div(as, bs, F(0.7));
+    EXPECT_EQ(a, e);
+    dizzy::madd(a, b, c, d);
+    dizzy::madd(as, bs, cs, ds);
+    EXPECT_EQ(a, e);
+    dizzy::madd(a, b, c, F(0.5));
+    dizzy::madd(as, bs, cs, F(0.5));
+    EXPECT_EQ(a, e);
+}
+
+/* Whether add(dst, x, y) compiles for these types */
+template <typename A, typename B, typename = void>
+struct CanAdd : std::false_type {};
+
+template <typename A, typename B>
+struct CanAdd<A, B, decltype(dizzy::add(std::declval<A &>(),
+                                        std::declval<const B &>(),
+                                        std::declval<const B &>()))>
+        : std::true_type {};
+
+}
+
+TEST(FixedTest, MatchesSpans) {
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        expectFixedMatchesSpans<float, 3>();
+        expectFixedMatchesSpans<float, 64>();
+        expectFixedMatchesSpans<float, 100>();
+        expectFixedMatchesSpans<double, 5>();
+        expectFixedMatchesSpans<double, 128>();
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(FixedTest, SizeMismatch) {
+    /* Arrays of different sizes are rejected when compiling, rather than
+     * truncated to the shortest */
+    typedef std::array<float, 64> Block;
+    EXPECT_TRUE((CanAdd<Block, Block>::value));
+    EXPECT_FALSE((CanAdd<Block, std::array<float, 128> >::value));
+    EXPECT_FALSE((CanAdd<std::vector<float>, Block>::value));
+}
 
 int main(int argc, char** argv) {
     testing::InitGoogleMock(&argc, argv);
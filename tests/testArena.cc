@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy.h"
+#include "dizzy/arena.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+bool aligned(const void *p) {
+    return (uintptr_t) p % 64 == 0;
+}
+
+}
+
+TEST(ArenaTest, Allocate) {
+    dizzy::Arena arena(1000);
+    EXPECT_EQ(arena.size(), 1024u);
+
+    /* Every span starts a line, whatever came before it */
+    dizzy::Span a = arena.allocate(3);
+    dizzy::DoubleSpan b = arena.allocate<double>(17);
+    dizzy::Span c = arena.allocate(16);
+    EXPECT_EQ(a.size(), 3u);
+    EXPECT_EQ(b.size(), 17u);
+    EXPECT_TRUE(aligned(a.data()));
+    EXPECT_TRUE(aligned(b.data()));
+    EXPECT_TRUE(aligned(c.data()));
+    EXPECT_EQ((char *) b.data() - (char *) a.data(), 64);
+    EXPECT_EQ((char *) c.data() - (char *) b.data(), 192);
+    EXPECT_EQ(arena.used(), 320u);
+
+    /* Too much gives an empty span and leaves the arena as it was */
+    EXPECT_TRUE(arena.allocate(200).empty());
+    EXPECT_TRUE(arena.allocate(size_t(-1) / 2).empty());
+    EXPECT_EQ(arena.used(), 320u);
+    EXPECT_EQ(arena.allocate(176).size(), 176u);
+    EXPECT_EQ(arena.used(), 1024u);
+
+    arena.clear();
+    EXPECT_EQ(arena.allocate(3).data(), a.data());
+
+    dizzy::Arena none;
+    EXPECT_TRUE(none.allocate(1).empty());
+}
+
+TEST(ArenaTest, Scope) {
+    dizzy::Arena arena(4096);
+    dizzy::Span outer = arena.allocate(10);
+    float *next;
+    {
+        dizzy::Arena::Scope scope(arena);
+        next = arena.allocate(100).data();
+        {
+            dizzy::Arena::Scope inner(arena);
+            arena.allocate(500);
+            EXPECT_EQ(arena.used(), 64u + 448u + 2048u);
+        }
+        EXPECT_EQ(arena.used(), 64u + 448u);
+    }
+    EXPECT_EQ(arena.used(), 64u);
+    EXPECT_EQ(arena.allocate(1).data(), next);
+    EXPECT_EQ(outer.size(), 10u);
+}
+
+TEST(ArenaTest, Local) {
+    /* Each thread has its own arena */
+    dizzy::Arena &mine = dizzy::Arena::local();
+    mine.reserve(256);
+    dizzy::Arena *theirs = NULL;
+    std::thread t([&]() {
+        theirs = &dizzy::Arena::local();
+        EXPECT_EQ(theirs->size(), 0u);
+    });
+    t.join();
+    EXPECT_NE(theirs, &mine);
+    EXPECT_EQ(&dizzy::Arena::local(), &mine);
+    EXPECT_EQ(mine.size(), 256u);
+}
+
+TEST(ArenaTest, Kernels) {
+    /* Scratch spans work with dizzy functions at every level */
+    std::vector<float> x(1000), y(1000);
+    dizzy::ramp(x, 0.0f, 999.0f);
+    dizzy::Arena arena(16384);
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        dizzy::Arena::Scope scope(arena);
+        dizzy::Span a = arena.allocate(x.size());
+        dizzy::Span b = arena.allocate(x.size());
+        dizzy::Span xs(x);
+        dizzy::mul(a, xs, 2.0f);
+        dizzy::add(b, a, 1.0f);
+        std::copy(b.begin(), b.end(), y.begin());
+        for (size_t i = 0; i < y.size(); i++) {
+            EXPECT_THAT(y[i], Near(2.0f * i + 1.0f, 1e-3));
+        }
+        EXPECT_THAT(dizzy::max(b), Near(1999.0f, 1e-3));
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(PoolTest, Reuse) {
+    dizzy::Pool pool(100, 3);
+    EXPECT_EQ(pool.size(), 100u);
+    EXPECT_EQ(pool.available(), 3u);
+
+    dizzy::Span a = pool.acquire();
+    dizzy::Span b = pool.acquire();
+    dizzy::Span c = pool.acquire();
+    EXPECT_EQ(a.size(), 100u);
+    EXPECT_TRUE(aligned(a.data()));
+    EXPECT_TRUE(aligned(b.data()));
+    EXPECT_TRUE(aligned(c.data()));
+    EXPECT_EQ(b.data() - a.data(), 112);
+    EXPECT_TRUE(pool.acquire().empty());
+    EXPECT_EQ(pool.available(), 0u);
+
+    /* Buffers come back in any order */
+    pool.release(b);
+    pool.release(dizzy::Span());
+    pool.release(a);
+    EXPECT_EQ(pool.available(), 2u);
+    EXPECT_EQ(pool.acquire().data(), a.data());
+    EXPECT_EQ(pool.acquire().data(), b.data());
+
+    dizzy::DoublePool doubles(5, 2);
+    dizzy::DoubleSpan d = doubles.acquire();
+    EXPECT_EQ(d.size(), 5u);
+    EXPECT_TRUE(aligned(d.data()));
+    EXPECT_EQ(doubles.acquire().data() - d.data(), 8);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,112 @@
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/convolver.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+std::vector<float> signal(size_t n, float seed) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = std::sin(seed * i * i + 0.1f * i);
+    }
+    return x;
+}
+
+std::vector<float> convolve(const std::vector<float> &x,
+                            const std::vector<float> &ir, size_t delay) {
+    std::vector<float> y(x.size(), 0.0f);
+    for (size_t i = delay; i < x.size(); i++) {
+        double sum = 0.0;
+        for (size_t k = 0; k < ir.size() && k <= i - delay; k++) {
+            sum += ir[k] * x[i - delay - k];
+        }
+        y[i] = sum;
+    }
+    return y;
+}
+
+/* Feed x through the convolver in irregular chunks */
+std::vector<float> run(dizzy::Convolver &convolver,
+                       const std::vector<float> &x) {
+    std::vector<float> y(x.size());
+    size_t sizes[] = {1, 7, 64, 100, 3, 250};
+    for (size_t i = 0, j = 0; i < x.size(); j++) {
+        size_t n = std::min(sizes[j % 6], x.size() - i);
+        std::vector<float> in(x.begin() + i, x.begin() + i + n), out(n);
+        convolver.process(out, in);
+        std::copy(out.begin(), out.end(), y.begin() + i);
+        i += n;
+    }
+    return y;
+}
+
+}
+
+TEST(ConvolverTest, BlockLatency) {
+    std::vector<float> x = signal(3000, 0.013f), ir = signal(1000, 0.7f);
+
+    dizzy::Convolver convolver(ir, 64);
+    std::vector<float> y = run(convolver, x);
+    std::vector<float> expected = convolve(x, ir, 64);
+
+    EXPECT_EQ(convolver.latency(), 64u);
+    for (size_t i = 0; i < y.size(); i++) {
+        EXPECT_THAT(y[i], Near(expected[i], 1e-3));
+    }
+}
+
+TEST(ConvolverTest, ZeroLatency) {
+    std::vector<float> x = signal(3000, 0.013f), ir = signal(1000, 0.7f);
+
+    dizzy::Convolver convolver(ir, 32, dizzy::Convolver::ZERO_LATENCY);
+    std::vector<float> y = run(convolver, x);
+    std::vector<float> expected = convolve(x, ir, 0);
+
+    EXPECT_EQ(convolver.latency(), 0u);
+    for (size_t i = 0; i < y.size(); i++) {
+        EXPECT_THAT(y[i], Near(expected[i], 1e-3));
+    }
+}
+
+TEST(ConvolverTest, ShortResponses) {
+    std::vector<float> x = signal(500, 0.02f), ir = {0.5f, -0.25f, 0.125f};
+
+    dizzy::Convolver head(ir, 64, dizzy::Convolver::ZERO_LATENCY);
+    std::vector<float> y = run(head, x);
+    std::vector<float> expected = convolve(x, ir, 0);
+    for (size_t i = 0; i < y.size(); i++) {
+        EXPECT_THAT(y[i], Near(expected[i], 1e-6));
+    }
+
+    dizzy::Convolver block(ir, 16);
+    y = run(block, x);
+    expected = convolve(x, ir, 16);
+    for (size_t i = 0; i < y.size(); i++) {
+        EXPECT_THAT(y[i], Near(expected[i], 1e-5));
+    }
+}
+
+TEST(ConvolverTest, Reset) {
+    std::vector<float> x = signal(300, 0.02f), ir = signal(100, 0.3f);
+
+    dizzy::Convolver convolver(ir, 16, dizzy::Convolver::ZERO_LATENCY);
+    std::vector<float> first = run(convolver, x);
+    convolver.reset();
+    std::vector<float> second = run(convolver, x);
+
+    for (size_t i = 0; i < x.size(); i++) {
+        EXPECT_THAT(second[i], testing::FloatEq(first[i]));
+    }
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/expr.h"
+
+TEST(ExprTest, ArithmeticIntegers) {
+    std::array<float, 4> a, b={520,933,26,933}, c={813,80,395,524}, d={1852,1945,446,2389};
+
+    dizzy::eval(a, dizzy::lazy(b) * 2.0f + dizzy::lazy(c) - 1.0f);
+
+    EXPECT_THAT(a, testing::Eq(d));
+}
+
+TEST(ExprTest, MatchesEagerFunctions) {
+    std::array<float, 4> a, b, x={0.25,-0.75,1.5,-2}, y={0.5,0.5,-0.25,0.125};
+
+    dizzy::mul(b, x, 0.8f);
+    dizzy::add(b, b, y);
+    dizzy::clamp(b, b, -1.0f, 1.0f);
+
+    dizzy::eval(a, dizzy::clamp(dizzy::lazy(x) * 0.8f + dizzy::lazy(y),
+                                -1.0f, 1.0f));
+
+    EXPECT_THAT(a, testing::Eq(b));
+
+    /* The bounds win ties, as they do eagerly */
+    x = {-0.0f, 0.5f, 1.0f, -1.0f};
+    dizzy::clamp(b, x, 0.0f, 1.0f);
+    dizzy::eval(a, dizzy::clamp(dizzy::lazy(x), 0.0f, 1.0f));
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_EQ(std::signbit(a[i]), std::signbit(b[i]));
+    }
+    EXPECT_THAT(a, testing::Eq(b));
+}
+
+TEST(ExprTest, Functions) {
+    std::array<float, 4> a, b={0.5,1.25,2.75,4}, c;
+
+    dizzy::eval(a, dizzy::sqrt(dizzy::abs(-dizzy::lazy(b))) +
+                   dizzy::fract(dizzy::lazy(b)));
+
+    for (size_t i = 0; i < c.size(); i++) {
+        c[i] = std::sqrt(b[i]) + (b[i] - std::floor(b[i]));
+    }
+    EXPECT_THAT(a[0], testing::FloatEq(c[0]));
+    EXPECT_THAT(a[1], testing::FloatEq(c[1]));
+    EXPECT_THAT(a[2], testing::FloatEq(c[2]));
+    EXPECT_THAT(a[3], testing::FloatEq(c[3]));
+}
+
+TEST(ExprTest, Double) {
+    std::vector<double> a(4), b={1, 2, 3, 4};
+    std::vector<float> c={0.5f, 0.5f, 0.5f, 0.5f};
+
+    /* Evaluated in double throughout, promoting the float operand */
+    dizzy::eval(a, dizzy::lazy(b) * 0.1 + dizzy::lazy(c) + 1e-12);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(a[i], testing::DoubleEq(b[i] * 0.1 + 0.5 + 1e-12));
+    }
+
+    dizzy::lazy(a) = dizzy::clamp(dizzy::sqrt(dizzy::lazy(b)), 1.1, 1.9);
+    EXPECT_THAT(a, testing::ElementsAre(1.1, std::sqrt(2.0), std::sqrt(3.0),
+                                        1.9));
+}
+
+TEST(ExprTest, AssignAndShortestLength) {
+    std::vector<float> a(5, -1.0f), b={1,2,3}, c={4,5,6,7};
+
+    dizzy::lazy(a) = 1.0f / dizzy::lazy(b) * dizzy::lazy(c);
+
+    EXPECT_THAT(a, testing::ElementsAre(4, 2.5, 2, -1, -1));
+}
+
+TEST(ExprTest, InPlace) {
+    std::vector<float> a={1,2,3,4};
+
+    dizzy::lazy(a) = dizzy::lazy(a) * dizzy::lazy(a);
+
+    EXPECT_THAT(a, testing::ElementsAre(1, 4, 9, 16));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
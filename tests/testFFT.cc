@@ -0,0 +1,146 @@
+#include <cmath>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/fft.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+void dft(std::vector<float> &dstReal, std::vector<float> &dstImag,
+         const std::vector<float> &xReal, const std::vector<float> &xImag) {
+    size_t n = xReal.size();
+    for (size_t k = 0; k < n; k++) {
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double angle = -2.0 * dizzy::fft::pi * ((i * k) % n) / n;
+            re += xReal[i] * std::cos(angle) - xImag[i] * std::sin(angle);
+            im += xReal[i] * std::sin(angle) + xImag[i] * std::cos(angle);
+        }
+        dstReal[k] = re;
+        dstImag[k] = im;
+    }
+}
+
+std::vector<float> signal(size_t n, float seed) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = std::sin(seed * i * i + 0.3f * i) + 0.25f * std::cos(seed * i);
+    }
+    return x;
+}
+
+const size_t sizes[] = {1, 2, 3, 4, 5, 7, 8, 9, 12, 15, 16, 30, 64, 90, 360,
+                        512};
+
+}
+
+TEST(FFTTest, ComplexMatchesDFT) {
+    dizzy::simd::Level levels[] = {dizzy::simd::SCALAR, dizzy::simd::SSE2,
+                                   dizzy::simd::AVX2, dizzy::simd::AVX512};
+    for (dizzy::simd::Level level : levels) {
+        dizzy::simd::setLevel(level);
+        for (size_t n : sizes) {
+            std::vector<float> xReal = signal(n, 0.7f);
+            std::vector<float> xImag = signal(n, 1.3f);
+            std::vector<float> re(n), im(n), expectedRe(n), expectedIm(n);
+
+            dizzy::FFT fft(n);
+            fft.forwardCplx(re, im, xReal, xImag);
+            dft(expectedRe, expectedIm, xReal, xImag);
+
+            float error = 1e-5f * n;
+            for (size_t k = 0; k < n; k++) {
+                EXPECT_THAT(re[k], Near(expectedRe[k], error)) << n;
+                EXPECT_THAT(im[k], Near(expectedIm[k], error)) << n;
+            }
+
+            std::vector<float> yReal(n), yImag(n);
+            fft.inverseCplx(yReal, yImag, re, im);
+            for (size_t i = 0; i < n; i++) {
+                EXPECT_THAT(yReal[i], Near(xReal[i], 1e-5)) << n;
+                EXPECT_THAT(yImag[i], Near(xImag[i], 1e-5)) << n;
+            }
+        }
+    }
+    dizzy::simd::setLevel(dizzy::simd::detect());
+}
+
+TEST(FFTTest, RealMatchesDFT) {
+    for (size_t n : sizes) {
+        std::vector<float> x = signal(n, 0.9f), zero(n);
+        std::vector<float> re(n), im(n), expectedRe(n), expectedIm(n);
+
+        dizzy::FFT fft(n);
+        fft.forward(re, im, x);
+        dft(expectedRe, expectedIm, x, zero);
+
+        float error = 1e-5f * n;
+        for (size_t k = 0; k < n; k++) {
+            EXPECT_THAT(re[k], Near(expectedRe[k], error)) << n;
+            EXPECT_THAT(im[k], Near(expectedIm[k], error)) << n;
+        }
+
+        std::vector<float> y(n);
+        fft.inverse(y, re, im);
+        for (size_t i = 0; i < n; i++) {
+            EXPECT_THAT(y[i], Near(x[i], 1e-5)) << n;
+        }
+    }
+}
+
+TEST(FFTTest, RealHalfSpectrum) {
+    std::vector<float> x = signal(16, 0.5f), y(16);
+    std::vector<float> fullRe(16), fullIm(16);
+
+    dizzy::FFT fft(16);
+    fft.forward(fullRe, fullIm, x);
+
+    std::vector<float> halfRe(9), halfIm(9);
+    fft.forward(halfRe, halfIm, x);
+    for (size_t k = 0; k < 9; k++) {
+        EXPECT_THAT(halfRe[k], testing::FloatEq(fullRe[k]));
+        EXPECT_THAT(halfIm[k], testing::FloatEq(fullIm[k]));
+    }
+    EXPECT_THAT(halfIm[0], testing::FloatEq(0.0f));
+    EXPECT_THAT(halfIm[8], testing::FloatEq(0.0f));
+
+    fft.inverse(y, halfRe, halfIm);
+    for (size_t i = 0; i < 16; i++) {
+        EXPECT_THAT(y[i], Near(x[i], 1e-5));
+    }
+}
+
+TEST(FFTTest, ZeroPadding) {
+    std::vector<float> x = {1.0f, 2.0f, 3.0f}, re(8), im(8);
+
+    dizzy::FFT fft(8);
+    fft.forward(re, im, x);
+
+    EXPECT_THAT(re[0], testing::FloatEq(6.0f));
+    EXPECT_THAT(im[0], testing::FloatEq(0.0f));
+    EXPECT_THAT(re[4], testing::FloatEq(2.0f));
+    EXPECT_THAT(im[4], Near(0.0f, 1e-6));
+    EXPECT_THAT(re[2], Near(-2.0f, 1e-6));
+    EXPECT_THAT(im[2], Near(-2.0f, 1e-6));
+}
+
+TEST(FFTTest, SharedPlans) {
+    std::shared_ptr<const dizzy::fft::Plan> a = dizzy::fft::Plan::get(48);
+    std::shared_ptr<const dizzy::fft::Plan> b = dizzy::fft::Plan::get(48);
+    std::shared_ptr<const dizzy::fft::Plan> c = dizzy::fft::Plan::get(64);
+
+    EXPECT_EQ(a.get(), b.get());
+    EXPECT_NE(a.get(), c.get());
+    EXPECT_EQ(a->size(), 48u);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,200 @@
+#include <deque>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/filter.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+std::vector<float> signal(size_t n) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = std::sin(0.37f * i) + 0.5f * std::cos(1.9f * i * i);
+    }
+    return x;
+}
+
+}
+
+TEST(FilterTest, DirectForm) {
+    std::array<float, 6> a, b={1, 2, -1, 0, 0.5, 3}, c;
+
+    dizzy::Filter filter(2, 2);
+    filter.b[0] = 0.5f;
+    filter.b[1] = 0.25f;
+    filter.a[1] = -0.5f;
+    filter.filter(a, b);
+
+    float x1 = 0.0f, y1 = 0.0f;
+    for (size_t i = 0; i < b.size(); i++) {
+        c[i] = 0.5f * b[i] + 0.25f * x1 + 0.5f * y1;
+        x1 = b[i];
+        y1 = c[i];
+    }
+
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(a[i], testing::FloatEq(c[i]));
+    }
+}
+
+TEST(FilterTest, NormalizesAndKeepsHistory) {
+    std::vector<float> x = signal(40), y(40), a(20), b(20);
+
+    dizzy::Filter reference(3, 3), filter(3, 3);
+    reference.b = {0.2f, 0.4f, 0.2f};
+    reference.a = {1.0f, -0.3f, 0.1f};
+    filter.b = {0.4f, 0.8f, 0.4f};
+    filter.a = {2.0f, -0.6f, 0.2f};
+
+    reference.filter(y, x);
+    std::vector<float> x1(x.begin(), x.begin() + 20);
+    std::vector<float> x2(x.begin() + 20, x.end());
+    filter.filter(a, x1);
+    filter.filter(b, x2);
+
+    for (size_t i = 0; i < 20; i++) {
+        EXPECT_THAT(a[i], testing::FloatEq(y[i]));
+        EXPECT_THAT(b[i], testing::FloatEq(y[i + 20]));
+    }
+
+    filter.clearHistory();
+    filter.filter(a, x1);
+    EXPECT_THAT(a[0], testing::FloatEq(y[0]));
+}
+
+TEST(BiquadTest, Cascade) {
+    std::vector<float> x = signal(100), a(100), b(100), c(100);
+    dizzy::Biquad lowpass = dizzy::Biquad::lowpass(0.1f, 0.707f);
+    dizzy::Biquad peak = dizzy::Biquad::peak(0.02f, 2.0f, 6.0f);
+
+    dizzy::BiquadFilter cascade(2);
+    cascade.set(0, lowpass);
+    cascade.set(1, peak);
+    cascade.filter(a, x);
+
+    dizzy::Filter first(3, 3), second(3, 3);
+    first.b = {lowpass.b0, lowpass.b1, lowpass.b2};
+    first.a = {1.0f, lowpass.a1, lowpass.a2};
+    second.b = {peak.b0, peak.b1, peak.b2};
+    second.a = {1.0f, peak.a1, peak.a2};
+    first.filter(b, x);
+    second.filter(c, b);
+
+    for (size_t i = 0; i < x.size(); i++) {
+        EXPECT_THAT(a[i], Near(c[i], 1e-5));
+    }
+}
+
+TEST(BiquadTest, ChannelsMatchSingleFilters) {
+    const size_t channels = 19, frames = 50;
+    std::vector<float> x = signal(channels * frames), y(x.size());
+
+    dizzy::simd::Level levels[] = {dizzy::simd::SCALAR, dizzy::simd::SSE2,
+                                   dizzy::simd::AVX2, dizzy::simd::AVX512};
+    for (dizzy::simd::Level level : levels) {
+        dizzy::simd::setLevel(level);
+
+        dizzy::BiquadFilter bank(2, channels);
+        for (size_t c = 0; c < channels; c++) {
+            bank.set(0, dizzy::Biquad::lowpass(0.01f + 0.02f * c, 0.8f), c);
+            bank.set(1, dizzy::Biquad::highShelf(0.2f, 0.7f, c - 9.0f), c);
+        }
+
+        /* Two calls, to check the history is carried over */
+        std::vector<float> x1(x.begin(), x.begin() + 20 * channels);
+        std::vector<float> x2(x.begin() + 20 * channels, x.end());
+        std::vector<float> y1(x1.size()), y2(x2.size());
+        bank.filter(y1, x1);
+        bank.filter(y2, x2);
+        std::copy(y1.begin(), y1.end(), y.begin());
+        std::copy(y2.begin(), y2.end(), y.begin() + y1.size());
+
+        for (size_t c = 0; c < channels; c++) {
+            dizzy::BiquadFilter single(2);
+            single.set(0, dizzy::Biquad::lowpass(0.01f + 0.02f * c, 0.8f));
+            single.set(1, dizzy::Biquad::highShelf(0.2f, 0.7f, c - 9.0f));
+
+            std::vector<float> in(frames), out(frames);
+            for (size_t f = 0; f < frames; f++) {
+                in[f] = x[f * channels + c];
+            }
+            single.filter(out, in);
+
+            for (size_t f = 0; f < frames; f++) {
+                EXPECT_THAT(y[f * channels + c], Near(out[f], 1e-5));
+            }
+        }
+    }
+    dizzy::simd::setLevel(dizzy::simd::detect());
+}
+
+TEST(BiquadTest, Designs) {
+    std::vector<float> x(2000, 1.0f), y(2000);
+
+    dizzy::BiquadFilter lowpass(1);
+    lowpass.set(0, dizzy::Biquad::lowpass(0.05f, 0.707f));
+    lowpass.filter(y, x);
+    EXPECT_THAT(y.back(), Near(1.0f, 1e-4));
+
+    dizzy::BiquadFilter highpass(1);
+    highpass.set(0, dizzy::Biquad::highpass(0.05f, 0.707f));
+    highpass.filter(y, x);
+    EXPECT_THAT(y.back(), Near(0.0f, 1e-4));
+
+    dizzy::BiquadFilter shelf(1);
+    shelf.set(0, dizzy::Biquad::lowShelf(0.05f, 0.707f, 6.0f));
+    shelf.filter(y, x);
+    EXPECT_THAT(y.back(), Near(std::pow(10.0f, 6.0f / 20.0f), 1e-3));
+}
+
+TEST(BiquadTest, NonContiguous) {
+    std::vector<float> x = signal(1000), y(1000);
+    std::deque<float> a(x.begin(), x.end()), b(1000);
+
+    dizzy::BiquadFilter first(1, 2), second(1, 2);
+    first.set(0, dizzy::Biquad::bandpass(0.1f, 3.0f));
+    second.set(0, dizzy::Biquad::bandpass(0.1f, 3.0f));
+    first.filter(y, x);
+    second.filter(b, a);
+
+    for (size_t i = 0; i < x.size(); i++) {
+        EXPECT_THAT(b[i], testing::FloatEq(y[i]));
+    }
+}
+
+TEST(BiquadTest, NoSections) {
+    /* An empty cascade is a pass-through too */
+    std::vector<float> x = signal(100), y(100, 7.0f);
+    std::deque<float> a(x.begin(), x.end()), b(100, 7.0f);
+    dizzy::BiquadFilter filter(0, 3);
+    filter.filter(y, x);
+    filter.filter(b, a);
+    EXPECT_THAT(std::vector<float>(y.begin(), y.begin() + 99),
+                testing::ElementsAreArray(x.begin(), x.begin() + 99));
+    EXPECT_EQ(y[99], 7.0f);
+    EXPECT_THAT(std::vector<float>(b.begin(), b.begin() + 99),
+                testing::ElementsAreArray(x.begin(), x.begin() + 99));
+}
+
+TEST(BiquadTest, NoChannels) {
+    /* Nothing to filter, and nothing is touched */
+    std::vector<float> x = signal(100), y(100, 1.0f);
+    std::deque<float> a(x.begin(), x.end()), b(100, 1.0f);
+    dizzy::BiquadFilter filter(2, 0);
+    EXPECT_EQ(filter.numChannels(), 0u);
+    filter.filter(y, x);
+    filter.filter(b, a);
+    EXPECT_THAT(y, testing::Each(1.0f));
+    EXPECT_THAT(b, testing::Each(1.0f));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
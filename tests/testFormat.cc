@@ -0,0 +1,216 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/format.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+std::vector<float> ramp(size_t n, float start, float end) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = start + (end - start) * i / (n - 1);
+    }
+    return x;
+}
+
+}
+
+TEST(FormatTest, RoundTrip) {
+    dizzy::SampleFormat formats[] = {dizzy::INT16, dizzy::INT24,
+                                     dizzy::INT32};
+    for (dizzy::SampleFormat format : formats) {
+        std::vector<float> left = ramp(1000, -1.0f, 0.99f);
+        std::vector<float> right = ramp(1000, 0.5f, -0.5f);
+        const std::vector<float> *srcs[] = {&left, &right};
+        std::vector<unsigned char> frames(2 * 1000 *
+                                          dizzy::sampleBytes(format));
+        dizzy::encode(frames.data(), format, srcs, 2);
+
+        std::vector<float> a(1000), b(1000);
+        std::vector<float> *dsts[] = {&a, &b};
+        dizzy::decode(dsts, 2, frames.data(), format);
+
+        float lsb = 1.0f / dizzy::detail::formatScale(format);
+        for (size_t i = 0; i < 1000; i++) {
+            EXPECT_THAT(a[i], Near(left[i], lsb));
+            EXPECT_THAT(b[i], Near(right[i], lsb));
+        }
+    }
+}
+
+TEST(FormatTest, Layout) {
+    std::vector<float> left = {0.5f, -1.0f}, right = {-0.5f, 1.5f};
+    const std::vector<float> *srcs[] = {&left, &right};
+
+    std::vector<unsigned char> int16(8);
+    dizzy::encode(int16.data(), dizzy::INT16, srcs, 2);
+    EXPECT_THAT(int16, testing::ElementsAre(0x00, 0x40, 0x00, 0xc0,
+                                            0x00, 0x80, 0xff, 0x7f));
+
+    std::vector<unsigned char> int24(12);
+    dizzy::encode(int24.data(), dizzy::INT24, srcs, 2);
+    EXPECT_THAT(int24, testing::ElementsAre(0x00, 0x00, 0x40,
+                                            0x00, 0x00, 0xc0,
+                                            0x00, 0x00, 0x80,
+                                            0xff, 0xff, 0x7f));
+
+    std::vector<unsigned char> int32(16);
+    dizzy::encode(int32.data(), dizzy::INT32, srcs, 2);
+    EXPECT_THAT(int32, testing::ElementsAre(0x00, 0x00, 0x00, 0x40,
+                                            0x00, 0x00, 0x00, 0xc0,
+                                            0x00, 0x00, 0x00, 0x80,
+                                            0x80, 0xff, 0xff, 0x7f));
+}
+
+TEST(FormatTest, Saturation) {
+    std::vector<float> x = {1.5f, -1.5f, 1.0f, INFINITY, -INFINITY, NAN};
+    std::vector<int16_t> y(x.size());
+    dizzy::encode(y.data(), dizzy::INT16, x);
+    EXPECT_THAT(y, testing::ElementsAre(32767, -32768, 32767, 32767, -32768,
+                                        testing::_));
+
+    std::vector<int32_t> z(x.size());
+    dizzy::encode(z.data(), dizzy::INT32, x);
+    EXPECT_THAT(z, testing::ElementsAre(2147483520, INT32_MIN, 2147483520,
+                                        2147483520, INT32_MIN, testing::_));
+}
+
+TEST(FormatTest, Half) {
+    std::vector<float> x = {1.0f, -2.0f, 65504.0f, 1e6f, INFINITY,
+                            std::ldexp(1.0f, -24), std::ldexp(1.0f, -14),
+                            0.0f, 1.0f + std::ldexp(1.0f, -11)};
+    std::vector<uint16_t> h(x.size());
+    dizzy::encode(h.data(), dizzy::FLOAT16, x);
+    EXPECT_THAT(h, testing::ElementsAre(0x3c00, 0xc000, 0x7bff, 0x7c00,
+                                        0x7c00, 0x0001, 0x0400, 0x0000,
+                                        0x3c00));
+
+    std::vector<float> y = ramp(777, -3.0f, 3.0f), z(777);
+    std::vector<uint16_t> encoded(777);
+    dizzy::encode(encoded.data(), dizzy::FLOAT16, y);
+    dizzy::decode(z, encoded.data(), dizzy::FLOAT16);
+    for (size_t i = 0; i < y.size(); i++) {
+        EXPECT_THAT(z[i], Near(y[i], std::fabs(y[i]) / 2048.0f));
+    }
+}
+
+TEST(FormatTest, Dither) {
+    /* A constant a third of an LSB between two steps keeps its mean */
+    float value = 1000.3f / 32768.0f;
+    std::vector<float> x(20000, value);
+    std::vector<int16_t> y(x.size());
+    dizzy::Dither dither(1);
+    dizzy::encode(y.data(), dizzy::INT16, x, &dither);
+
+    double sum = 0.0;
+    for (int16_t v : y) {
+        EXPECT_THAT(v, testing::AllOf(testing::Ge(998), testing::Le(1002)));
+        sum += v;
+    }
+    EXPECT_THAT(sum / y.size(), Near(1000.3, 0.05));
+
+    std::vector<int16_t> plain(x.size());
+    dizzy::encode(plain.data(), dizzy::INT16, x);
+    EXPECT_THAT(plain, testing::Each(1000));
+}
+
+TEST(FormatTest, Shaping) {
+    /* Smoothly windowed sums of the error over blocks measure the low
+     * frequency noise */
+    std::vector<float> x = ramp(32768, -0.25f, 0.25f);
+    dizzy::Dither::Shaping shapings[] = {dizzy::Dither::FLAT,
+                                         dizzy::Dither::FIRST_ORDER,
+                                         dizzy::Dither::SECOND_ORDER};
+    double power[3];
+    for (int s = 0; s < 3; s++) {
+        dizzy::Dither dither(1, shapings[s], 7);
+        std::vector<int16_t> y(x.size());
+        dizzy::encode(y.data(), dizzy::INT16, x, &dither);
+
+        power[s] = 0.0;
+        for (size_t i = 0; i < x.size(); i += 256) {
+            double error = 0.0;
+            for (size_t j = 0; j < 256; j++) {
+                double w = 1.0 - std::cos(6.283185307 * j / 256);
+                error += w * (y[i + j] - x[i + j] * 32768.0);
+            }
+            power[s] += error * error;
+        }
+    }
+    EXPECT_LT(power[1], power[0] / 100);
+    EXPECT_LT(power[2], power[1]);
+}
+
+TEST(FormatTest, Levels) {
+    std::vector<float> x = ramp(1001, -1.2f, 1.2f), reference(1001), y(1001);
+    std::vector<int32_t> expected(1001), encoded(1001);
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    dizzy::simd::setLevel(dizzy::simd::SCALAR);
+    dizzy::encode(expected.data(), dizzy::INT32, x);
+    dizzy::decode(reference, expected.data(), dizzy::INT24);
+    for (int l = dizzy::simd::SSE2; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        dizzy::encode(encoded.data(), dizzy::INT32, x);
+        EXPECT_EQ(encoded, expected);
+        dizzy::decode(y, expected.data(), dizzy::INT24);
+        EXPECT_EQ(y, reference);
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(FormatTest, Containers) {
+    std::vector<float> x = ramp(600, -1.0f, 1.0f), y(600), z(600);
+    std::vector<unsigned char> a(1200), b(1200);
+    dizzy::encode(a.data(), dizzy::INT16, x);
+
+    dizzy::StridedSpan xs(x.data(), x.size(), 1);
+    dizzy::encode(b.data(), dizzy::INT16, xs);
+    EXPECT_EQ(a, b);
+
+    dizzy::decode(y, a.data(), dizzy::INT16);
+    dizzy::StridedSpan zs(z.data(), z.size(), 1);
+    dizzy::decode(zs, a.data(), dizzy::INT16);
+    EXPECT_EQ(y, z);
+
+    /* Channels of unequal size run to the shortest */
+    std::vector<float> shorter(599);
+    const std::vector<float> *srcs[] = {&x, &shorter};
+    std::vector<unsigned char> c(2400, 0xaa);
+    EXPECT_EQ(dizzy::encode(c.data(), dizzy::INT16, srcs, 2), 599u);
+    EXPECT_EQ(c[2393], a[1197]);
+    EXPECT_EQ(c[2396], 0xaa);
+
+    std::vector<float> *dsts[] = {&y, &shorter};
+    std::fill(y.begin(), y.end(), 2.0f);
+    EXPECT_EQ(dizzy::decode(dsts, 2, c.data(), dizzy::INT16), 599u);
+    EXPECT_EQ(y[598], z[598]);
+    EXPECT_EQ(y[599], 2.0f);
+}
+
+TEST(FormatTest, DitherChannels) {
+    /* A dither made for fewer channels than are encoded is refused */
+    std::vector<float> x = ramp(300, -0.5f, 0.5f);
+    const std::vector<float> *srcs[] = {&x, &x, &x};
+    std::vector<int16_t> y(900, 7);
+    dizzy::Dither dither(2, dizzy::Dither::SECOND_ORDER);
+    EXPECT_EQ(dizzy::encode(y.data(), dizzy::INT16, srcs, 3, &dither), 0u);
+    EXPECT_THAT(y, testing::Each(7));
+
+    dizzy::Dither wider(4, dizzy::Dither::SECOND_ORDER);
+    EXPECT_EQ(dizzy::encode(y.data(), dizzy::INT16, srcs, 3, &wider), 300u);
+    EXPECT_EQ(wider.numChannels(), 4u);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,180 @@
+#include <cmath>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/graph.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+std::vector<float> sine(size_t n, float frequency, float phase=0.0f) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = std::sin(frequency * i + phase);
+    }
+    return x;
+}
+
+/* Custom node scaling its input, which the graph cannot fuse */
+dizzy::Graph::Function scale(float gain, size_t *calls=NULL) {
+    return [gain, calls](dizzy::Span dst,
+                         const std::vector<dizzy::Span> &in) {
+        dizzy::Span x = in[0];
+        dizzy::mul(dst, x, gain);
+        if (calls) {
+            (*calls)++;
+        }
+    };
+}
+
+}
+
+TEST(GraphTest, Arithmetic) {
+    /* Blocks longer than a fused tile and calls shorter than a block */
+    std::vector<float> x = sine(700, 0.01f), y = sine(700, 0.03f, 1.0f);
+    std::vector<float> expected(700), t(700);
+    dizzy::mul(t, x, 2.0f);
+    dizzy::add(t, t, y);
+    dizzy::div(t, t, 1.5f);
+    dizzy::madd(expected, t, y, 0.5f);
+    dizzy::mul(t, x, y);
+    dizzy::sub(t, expected, t);
+    dizzy::madd(expected, t, x, y);
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        dizzy::Graph graph(600);
+        dizzy::Graph::Node a = graph.input(), b = graph.input();
+        dizzy::Graph::Node u = graph.div(graph.add(graph.mul(a, 2.0f), b),
+                                         1.5f);
+        u = graph.sub(graph.madd(u, b, 0.5f), graph.mul(a, b));
+        graph.output(graph.madd(u, a, b));
+        graph.compile();
+        EXPECT_EQ(graph.numTasks(), 1u);
+        EXPECT_EQ(graph.numBuffers(), 1u);
+
+        std::vector<float> z(700);
+        for (size_t i = 0; i < 700; i += 350) {
+            std::vector<dizzy::Span> in = {dizzy::Span(&x[i], 350),
+                                           dizzy::Span(&y[i], 350)};
+            std::vector<dizzy::Span> out = {dizzy::Span(&z[i], 350)};
+            graph.process(out, in);
+        }
+        for (size_t i = 0; i < 700; i++) {
+            EXPECT_THAT(z[i], Near(expected[i], 1e-5));
+        }
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(GraphTest, Liveness) {
+    /* A chain of 200 nodes needs two buffers, not 200 */
+    dizzy::Graph graph(64);
+    dizzy::Graph::Node n = graph.input();
+    for (size_t i = 0; i < 200; i++) {
+        n = graph.node(std::vector<dizzy::Graph::Node>(1, n),
+                       scale(i % 2 ? 2.0f : 0.5f));
+    }
+    graph.output(n);
+    graph.compile();
+    EXPECT_EQ(graph.numTasks(), 200u);
+    EXPECT_EQ(graph.numBuffers(), 2u);
+
+    std::vector<float> x = sine(64, 0.1f), y(64);
+    std::vector<dizzy::Span> inputs = {dizzy::Span(x)};
+    std::vector<dizzy::Span> outputs = {dizzy::Span(y)};
+    graph.process(outputs, inputs);
+    for (size_t i = 0; i < 64; i++) {
+        EXPECT_THAT(y[i], testing::FloatEq(x[i]));
+    }
+}
+
+TEST(GraphTest, Parallel) {
+    /* Independent branches give the same result on a pool */
+    dizzy::parallel::ThreadPool pool(4);
+    std::vector<float> x = sine(256, 0.05f);
+    std::vector<float> serial(256), parallel(256);
+    for (int p = 0; p < 2; p++) {
+        dizzy::Graph graph(256, p ? &pool : NULL);
+        dizzy::Graph::Node in = graph.input();
+        std::vector<dizzy::Graph::Node> args(1, in);
+        dizzy::Graph::Node sum = graph.node(args, scale(1.0f));
+        for (size_t b = 1; b < 8; b++) {
+            sum = graph.add(sum, graph.node(args, scale(b + 1.0f)));
+        }
+        graph.output(sum);
+        graph.compile();
+        EXPECT_EQ(graph.numTasks(), 9u);
+        EXPECT_EQ(graph.numBuffers(), 9u);
+
+        std::vector<float> &y = p ? parallel : serial;
+        std::vector<dizzy::Span> inputs = {dizzy::Span(x)};
+        std::vector<dizzy::Span> outputs = {dizzy::Span(y)};
+        graph.process(outputs, inputs);
+    }
+    for (size_t i = 0; i < 256; i++) {
+        EXPECT_THAT(serial[i], Near(36.0f * x[i], 1e-4));
+        EXPECT_EQ(parallel[i], serial[i]);
+    }
+}
+
+TEST(GraphTest, Unused) {
+    /* Nodes no output needs never run, and missing inputs are silent */
+    size_t calls = 0;
+    dizzy::Graph graph(32);
+    dizzy::Graph::Node a = graph.input(), b = graph.input();
+    graph.node(std::vector<dizzy::Graph::Node>(1, a), scale(2.0f, &calls));
+    graph.output(graph.add(b, 1.0f));
+    graph.compile();
+    EXPECT_EQ(graph.numTasks(), 1u);
+
+    std::vector<float> x(32, 5.0f), y(32);
+    std::vector<dizzy::Span> inputs = {dizzy::Span(x)};
+    std::vector<dizzy::Span> outputs = {dizzy::Span(y)};
+    graph.process(outputs, inputs);
+    EXPECT_EQ(calls, 0u);
+    EXPECT_THAT(y, testing::Each(1.0f));
+}
+
+TEST(GraphTest, Filters) {
+    /* Filter and convolution nodes keep their state between blocks */
+    dizzy::Biquad lowpass = dizzy::Biquad::lowpass(0.05f, 0.7f);
+    std::vector<float> ir = sine(100, 0.3f);
+    dizzy::Graph graph(128);
+    dizzy::Graph::Node x = graph.input();
+    graph.output(graph.biquad(x, {lowpass, lowpass}));
+    graph.output(graph.convolve(x, ir));
+
+    dizzy::BiquadFilter filter(2);
+    filter.set(0, lowpass);
+    filter.set(1, lowpass);
+    dizzy::Convolver convolver(ir, 128);
+
+    std::vector<float> in = sine(512, 0.02f);
+    std::vector<float> a(128), b(128), c(128), d(128);
+    for (size_t i = 0; i < 512; i += 128) {
+        dizzy::Span block(&in[i], 128);
+        std::vector<dizzy::Span> inputs = {block};
+        std::vector<dizzy::Span> outputs = {dizzy::Span(a),
+                                            dizzy::Span(b)};
+        graph.process(outputs, inputs);
+        std::vector<float> x(block.begin(), block.end());
+        filter.filter(c, x);
+        convolver.process(d, x);
+        for (size_t j = 0; j < 128; j++) {
+            EXPECT_EQ(a[j], c[j]);
+            EXPECT_EQ(b[j], d[j]);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
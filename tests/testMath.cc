@@ -1,4 +1,6 @@
 #include <limits>
+#include <list>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -44,6 +46,17 @@ TEST(AtanTest, Values) {
     EXPECT_THAT(a[3], Near(c[3], 1e-4));
 }
 
+TEST(Atan2Test, Values) {
+    std::array<float, 4> a, b={1,1,-1,-2}, c={1,-1,-1,0}, d={0.7853981633974483,2.356194490192345,-2.356194490192345,-1.5707963267948966};
+
+    dizzy::atan2(a, b, c);
+
+    EXPECT_THAT(a[0], Near(d[0], 1e-4));
+    EXPECT_THAT(a[1], Near(d[1], 1e-4));
+    EXPECT_THAT(a[2], Near(d[2], 1e-4));
+    EXPECT_THAT(a[3], Near(d[3], 1e-4));
+}
+
 TEST(AbsTest, AbsInteger) {
     std::array<float, 4> a, b={119,844,770,695}, c={119,844,770,695};
 
@@ -298,6 +311,96 @@ TEST(SignTest, SignSignedZero) {
     EXPECT_THAT(a, testing::Eq(c));
 }
 
+namespace {
+
+/* Equal including the sign of zeros, with any NaN equal to any other */
+bool same(double a, double b) {
+    return (std::isnan(a) && std::isnan(b)) ||
+           (a == b && std::signbit(a) == std::signbit(b));
+}
+
+/* Halves, signed zeros, the edges of the integers and special values,
+ * then noise */
+template <typename F>
+std::vector<F> roundingValues() {
+    const F inf = std::numeric_limits<F>::infinity();
+    std::vector<F> x = {0.0, -0.0, 0.5, -0.5, 1.5, -1.5, 2.5, -2.5,
+                        0.49999997, -0.49999997, 0.3, -0.3, 0.7, -0.7,
+                        8388607.5, -8388607.5, 8388608.0, 16777217.0,
+                        3e9, -3e9, 1e30, -1e30, 1e-40, -1e-40, inf, -inf,
+                        std::numeric_limits<F>::quiet_NaN(), 1.0, -1.0};
+    std::vector<float> noise(200);
+    dizzy::Random(5).fill(noise, -40.0f, 40.0f);
+    x.insert(x.end(), noise.begin(), noise.end());
+    return x;
+}
+
+template <typename F, typename T>
+void expectRounding(T &x, T &y) {
+    std::vector<F> values = roundingValues<F>();
+    std::copy(values.begin(), values.end(), x.begin());
+    typedef F (*Reference)(F);
+    const Reference references[] = {std::floor, std::ceil, std::round};
+    void (*const functions[])(T &, const T &) = {
+        dizzy::floor<T>, dizzy::ceil<T>, dizzy::round<T>};
+    for (size_t f = 0; f < 3; f++) {
+        functions[f](y, x);
+        auto it = y.begin();
+        for (size_t i = 0; i < values.size(); i++, it++) {
+            EXPECT_TRUE(same(*it, references[f](values[i])))
+                    << f << " " << values[i] << " " << *it;
+        }
+    }
+
+    dizzy::fract(y, x);
+    auto it = y.begin();
+    for (size_t i = 0; i < values.size(); i++, it++) {
+        EXPECT_TRUE(same(*it, values[i] - std::floor(values[i])))
+                << values[i] << " " << *it;
+    }
+
+    dizzy::sign(y, x);
+    it = y.begin();
+    for (size_t i = 0; i < values.size(); i++, it++) {
+        F v = values[i];
+        F expected = v > 0 ? 1 : v < 0 ? -1 : 1 / v > 0 ? 1 : -1;
+        EXPECT_TRUE(same(*it, expected)) << values[i] << " " << *it;
+    }
+
+    /* Ties go to the bounds, NaN passes through, and the upper bound wins
+     * when the bounds are the wrong way round */
+    const F bounds[][2] = {{0.0, 1.0}, {-0.0, 0.0}, {-1.5, 2.5}, {3.0, -3.0}};
+    for (size_t b = 0; b < 4; b++) {
+        F low = bounds[b][0], high = bounds[b][1];
+        dizzy::clamp(y, x, low, high);
+        it = y.begin();
+        for (size_t i = 0; i < values.size(); i++, it++) {
+            F v = values[i];
+            F expected = v >= high ? high : v <= low ? low : v;
+            EXPECT_TRUE(same(*it, expected)) << values[i] << " " << *it;
+        }
+    }
+}
+
+}
+
+TEST(RoundingTest, SpecialValues) {
+    /* Every level, contiguous or not, gives what libm gives */
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        size_t n = roundingValues<float>().size();
+        std::vector<float> x(n), y(n), interleaved(2 * n);
+        expectRounding<float>(x, y);
+        dizzy::StridedSpan even(&interleaved[0], n, 2);
+        dizzy::StridedSpan odd(&interleaved[1], n, 2);
+        expectRounding<float>(even, odd);
+        std::vector<double> xd(n), yd(n);
+        expectRounding<double>(xd, yd);
+    }
+    dizzy::simd::setLevel(level);
+}
+
 TEST(SqrtTest, SqrtInteger) {
     std::array<float, 4> a, b={734,590,568,968}, c={27.09243436828813,24.289915602982237,23.83275057562597,31.11269837220809};
 
@@ -409,6 +512,284 @@ TEST(RandomTest, Values) {
     EXPECT_THAT(a[3], Between(-505.74774169921875, -364.25360107421875));
 }
 
+TEST(RandomTest, Range) {
+    std::vector<float> a(1001);
+    dizzy::Random random(1);
+    random.fill(a, -2.0f, 3.0f);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(a[i], Between(-2.0f, 3.0f));
+    }
+
+    float mean = 0.0f;
+    float meanSquare = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        mean += a[i] / a.size();
+        meanSquare += a[i] * a[i] / a.size();
+    }
+    EXPECT_NEAR(mean, 0.5f, 0.3f);
+    EXPECT_NEAR(meanSquare - mean * mean, 25.0f / 12.0f, 0.3f);
+}
+
+TEST(RandomTest, Chunked) {
+    std::vector<float> a(100), b(100);
+    dizzy::Random(7).fill(a);
+
+    dizzy::Random random(7);
+    size_t chunks[] = {3, 16, 1, 29, 51};
+    size_t offset = 0;
+    for (size_t i = 0; i < 5; i++) {
+        dizzy::Span span(b.data() + offset, chunks[i]);
+        random.fill(span);
+        offset += chunks[i];
+    }
+
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_FLOAT_EQ(a[i], b[i]);
+    }
+}
+
+TEST(RandomTest, Levels) {
+    std::list<float> expected(77);
+    dizzy::simd::Level level = dizzy::simd::level();
+    dizzy::simd::setLevel(dizzy::simd::SCALAR);
+    dizzy::Random(3, 2).fill(expected, -1.0f, 1.0f);
+
+    for (int l = dizzy::simd::SSE2; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        std::vector<float> a(77);
+        dizzy::Random(3, 2).fill(a, -1.0f, 1.0f);
+        auto it = expected.begin();
+        for (size_t i = 0; i < a.size(); i++, it++) {
+            EXPECT_THAT(a[i], Near(*it, 1e-6));
+        }
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(RandomTest, Streams) {
+    std::vector<float> a(64), b(64);
+    dizzy::Random(5, 0).fill(a);
+    dizzy::Random(5, 1).fill(b);
+
+    size_t same = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        same += a[i] == b[i];
+    }
+    EXPECT_LT(same, 2u);
+}
+
+/* Compares the sample kernels at every level against the generic loop,
+ * which strided spans take */
+void checkSample(size_t size, bool repeat, float low, float high) {
+    std::vector<float> table(size), t(203), a(203), b(203);
+    for (size_t i = 0; i < size; i++) {
+        table[i] = std::sin(i * 0.37f) * 4.0f;
+    }
+    dizzy::Random(11).fill(t, low, high);
+    t[0] = 0.0f;
+    t[1] = size - 1.0f;
+    t[2] = size;
+    t[3] = -1.0f;
+    t[4] = std::numeric_limits<float>::quiet_NaN();
+
+    dizzy::StridedSpan stridedTable(table.data(), size, 1);
+    dizzy::StridedSpan stridedT(t.data(), t.size(), 1);
+    dizzy::StridedSpan stridedB(b.data(), b.size(), 1);
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+
+        dizzy::sampleLinear(a, table, t, repeat);
+        dizzy::sampleLinear(stridedB, stridedTable, stridedT, repeat);
+        for (size_t i = 5; i < a.size(); i++) {
+            EXPECT_THAT(a[i], Near(b[i], 1e-4));
+        }
+        /* NaN positions must stay inside the table */
+        if (!repeat) {
+            EXPECT_THAT(a[4], Between(-4.0f, 4.0f));
+        }
+
+        dizzy::sampleCubic(a, table, t, repeat);
+        dizzy::sampleCubic(stridedB, stridedTable, stridedT, repeat);
+        for (size_t i = 5; i < a.size(); i++) {
+            EXPECT_THAT(a[i], Near(b[i], 1e-4));
+        }
+        if (!repeat) {
+            EXPECT_THAT(a[4], Between(-8.0f, 8.0f));
+        }
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(SampleTest, Clamp) {
+    checkSample(100, false, -20.0f, 120.0f);
+}
+
+TEST(SampleTest, Repeat) {
+    checkSample(100, true, -250.0f, 250.0f);
+    checkSample(3, true, -10.0f, 10.0f);
+}
+
+TEST(SampleTest, RepeatPowerOfTwo) {
+    checkSample(64, true, -250.0f, 250.0f);
+    checkSample(1, true, -10.0f, 10.0f);
+}
+
+TEST(SampleTest, Values) {
+    std::vector<float> x = {0, 1, 4, 9}, t = {1.5f, 3.5f, -0.5f}, a(3);
+
+    dizzy::sampleLinear(a, x, t);
+    EXPECT_THAT(a, testing::ElementsAre(2.5f, 9.0f, 0.0f));
+
+    dizzy::sampleLinear(a, x, t, true);
+    EXPECT_THAT(a, testing::ElementsAre(2.5f, 4.5f, 4.5f));
+
+    dizzy::sampleCubic(a, x, t, true);
+    EXPECT_THAT(a[0], Near(2.25f, 1e-6));
+}
+
+TEST(SampleTest, LargePhases) {
+    /* Positions past the integer range of the kernels stay in the table */
+    std::vector<float> x(16), t(37), a(37);
+    dizzy::ramp(x, 0.0f, 15.0f);
+    for (size_t i = 0; i < t.size(); i++) {
+        t[i] = (i % 2 ? -3e9f : 3e9f) * (1 + i);
+    }
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        dizzy::sampleLinear(a, x, t, true);
+        EXPECT_THAT(a, testing::Each(Between(0.0f, 15.0f)));
+        dizzy::sampleCubic(a, x, t, true);
+        EXPECT_THAT(a, testing::Each(Between(-1.0f, 16.0f)));
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(ApproxTest, SinTiers) {
+    std::vector<float> a(1000), b(1000), c(1000);
+    dizzy::ramp(b, -100.0f, 100.0f);
+    dizzy::sin(c, b);
+
+    float tolerance[] = {6e-4f, 2e-6f, 4e-7f};
+    for (int p = dizzy::approx::LOW; p <= dizzy::approx::HIGH; p++) {
+        dizzy::approx::sin(a, b, (dizzy::approx::Precision) p);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], Near(c[i], tolerance[p]));
+        }
+    }
+}
+
+TEST(ApproxTest, CosTiers) {
+    std::vector<float> a(1000), b(1000), c(1000);
+    dizzy::ramp(b, -100.0f, 100.0f);
+    dizzy::cos(c, b);
+
+    float tolerance[] = {6e-4f, 2e-6f, 4e-7f};
+    for (int p = dizzy::approx::LOW; p <= dizzy::approx::HIGH; p++) {
+        dizzy::approx::cos(a, b, (dizzy::approx::Precision) p);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], Near(c[i], tolerance[p]));
+        }
+    }
+}
+
+TEST(ApproxTest, TanTiers) {
+    std::vector<float> a(1000), b(1000), c(1000);
+    dizzy::ramp(b, -1.5f, 1.5f);
+    dizzy::tan(c, b);
+
+    float tolerance[] = {7e-4f, 3e-6f, 4e-7f};
+    for (int p = dizzy::approx::LOW; p <= dizzy::approx::HIGH; p++) {
+        dizzy::approx::tan(a, b, (dizzy::approx::Precision) p);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], Near(c[i], tolerance[p] * std::fabs(c[i])));
+        }
+    }
+}
+
+TEST(ApproxTest, ExpTiers) {
+    std::vector<float> a(1000), b(1000), c(1000);
+    dizzy::ramp(b, -100.0f, 88.0f);
+    dizzy::exp(c, b);
+
+    float tolerance[] = {1.3e-4f, 6e-6f, 1.2e-7f};
+    for (int p = dizzy::approx::LOW; p <= dizzy::approx::HIGH; p++) {
+        dizzy::approx::exp(a, b, (dizzy::approx::Precision) p);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], Near(c[i], tolerance[p] * c[i] + 1e-45f));
+        }
+    }
+}
+
+TEST(ApproxTest, LogTiers) {
+    std::vector<float> a(1000), b(1000), c(1000);
+    dizzy::ramp(b, 0.001f, 1000.0f);
+    dizzy::log(c, b);
+
+    float tolerance[] = {7e-4f, 1.3e-5f, 1.2e-7f};
+    for (int p = dizzy::approx::LOW; p <= dizzy::approx::HIGH; p++) {
+        dizzy::approx::log(a, b, (dizzy::approx::Precision) p);
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_THAT(a[i], Near(c[i], tolerance[p] * std::fabs(c[i])));
+        }
+    }
+}
+
+TEST(ApproxTest, SpecialValues) {
+    float inf = std::numeric_limits<float>::infinity();
+    std::array<float, 4> a, b={0,-0.5,inf,10000}, c={-inf,0,inf,9.21034037};
+
+    dizzy::approx::log(a, b);
+
+    EXPECT_THAT(a[0], testing::Eq(c[0]));
+    EXPECT_TRUE(std::isnan(a[1]));
+    EXPECT_THAT(a[2], testing::Eq(c[2]));
+    EXPECT_THAT(a[3], testing::FloatEq(c[3]));
+
+    std::array<float, 4> d={-inf,100,-200,std::numeric_limits<float>::quiet_NaN()};
+
+    dizzy::approx::exp(a, d);
+
+    EXPECT_THAT(a[0], testing::Eq(0));
+    EXPECT_THAT(a[1], testing::Eq(inf));
+    EXPECT_THAT(a[2], testing::Eq(0));
+    EXPECT_TRUE(std::isnan(a[3]));
+
+    std::array<float, 4> e={1e6,-1e9,inf,0.5}, f;
+
+    dizzy::approx::sin(a, e);
+    dizzy::sin(f, e);
+
+    EXPECT_THAT(a[0], testing::FloatEq(f[0]));
+    EXPECT_THAT(a[1], testing::FloatEq(f[1]));
+    EXPECT_TRUE(std::isnan(a[2]));
+    EXPECT_THAT(a[3], testing::FloatEq(f[3]));
+}
+
+TEST(ApproxTest, PowValues) {
+    std::array<float, 4> a, b={18.185063526500016,-2,-8,0}, c={1.4863683376461267,3,0.5,-1}, d={74.54186248779297,-8,0,std::numeric_limits<float>::infinity()};
+
+    dizzy::approx::pow(a, b, c);
+
+    EXPECT_THAT(a[0], testing::FloatEq(d[0]));
+    EXPECT_THAT(a[1], testing::FloatEq(d[1]));
+    EXPECT_TRUE(std::isnan(a[2]));
+    EXPECT_THAT(a[3], testing::Eq(d[3]));
+
+    std::array<float, 4> e={2,-3,0.5,1}, f={1024,-59049,0.0009765625,1};
+
+    dizzy::approx::pow(a, e, 10.0f);
+
+    EXPECT_THAT(a[0], testing::FloatEq(f[0] * 1.0f));
+    EXPECT_THAT(a[1], testing::FloatEq(59049));
+    EXPECT_THAT(a[2], testing::FloatEq(f[2]));
+    EXPECT_THAT(a[3], testing::Eq(f[3]));
+}
+
+
 int main(int argc, char** argv) {
     testing::InitGoogleMock(&argc, argv);
     return RUN_ALL_TESTS();
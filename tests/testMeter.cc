@@ -0,0 +1,147 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/meter.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+const float rate = 48000.0f;
+
+/* Interleaved sines of the same amplitude in every channel */
+std::vector<float> sine(size_t channels, size_t frames, float frequency,
+                        float amplitude, float phase=0.0f) {
+    std::vector<float> x(frames * channels);
+    for (size_t i = 0; i < frames; i++) {
+        float v = amplitude * std::sin(2.0 * 3.14159265358979 * frequency *
+                                       i / rate + phase);
+        for (size_t c = 0; c < channels; c++) {
+            x[i * channels + c] = v;
+        }
+    }
+    return x;
+}
+
+float dbfs(float db) {
+    return std::pow(10.0f, db / 20.0f);
+}
+
+}
+
+TEST(MeterTest, Levels) {
+    dizzy::Meter meter(2, rate, 0.1f);
+    EXPECT_THAT(meter.peak(0), testing::FloatEq(0.0f));
+    EXPECT_THAT(meter.rms(0), testing::FloatEq(0.0f));
+
+    std::vector<float> x = sine(2, 24000, 1000.0f, 0.5f);
+    x[2 * 23990 + 1] = -0.75f;
+    meter.process(x);
+    EXPECT_THAT(meter.peak(0), Near(0.5f, 1e-4));
+    EXPECT_THAT(meter.peak(1), testing::FloatEq(0.75f));
+    EXPECT_THAT(meter.rms(0), Near(0.5f / std::sqrt(2.0f), 1e-3));
+
+    /* The window moves on past the spike */
+    meter.process(sine(2, 9600, 1000.0f, 0.25f));
+    EXPECT_THAT(meter.peak(1), Near(0.25f, 1e-4));
+    EXPECT_THAT(meter.rms(1), Near(0.25f / std::sqrt(2.0f), 1e-3));
+}
+
+TEST(MeterTest, TruePeak) {
+    /* A quarter of the sample rate, sampled 45 degrees off its peaks */
+    std::vector<float> x = sine(1, 4803, rate / 4, 1.0f, 3.14159265f / 4);
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        dizzy::Meter meter(1, rate);
+        meter.process(x);
+
+        EXPECT_THAT(meter.peak(0), Near(std::sqrt(0.5f), 1e-4));
+        EXPECT_THAT(meter.truePeak(0), Near(1.0f, 0.03f));
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(MeterTest, Loudness) {
+    /* EBU Tech 3341 case 1: a stereo 1 kHz sine at -23 dBFS reads
+     * -23 LUFS */
+    dizzy::Meter meter(2, rate);
+    EXPECT_TRUE(std::isinf(meter.momentary()));
+    EXPECT_TRUE(std::isinf(meter.integrated()));
+
+    meter.process(sine(2, 20 * 48000, 1000.0f, dbfs(-23.0f)));
+    EXPECT_THAT(meter.momentary(), Near(-23.0f, 0.1f));
+    EXPECT_THAT(meter.shortTerm(), Near(-23.0f, 0.1f));
+    EXPECT_THAT(meter.integrated(), Near(-23.0f, 0.1f));
+}
+
+TEST(MeterTest, Gating) {
+    /* Case 3: quiet passages 13 LU down fall below the relative gate, and
+     * silence below the absolute one */
+    dizzy::Meter meter(2, rate);
+    std::vector<float> quiet = sine(2, 10 * 48000, 1000.0f, dbfs(-36.0f));
+    meter.process(quiet);
+    meter.process(sine(2, 60 * 48000, 1000.0f, dbfs(-23.0f)));
+    meter.process(quiet);
+    meter.process(std::vector<float>(2 * 10 * 48000, 0.0f));
+
+    EXPECT_THAT(meter.integrated(), Near(-23.0f, 0.1f));
+    EXPECT_TRUE(std::isinf(meter.momentary()));
+
+    meter.reset();
+    meter.process(quiet);
+    EXPECT_THAT(meter.integrated(), Near(-36.0f, 0.1f));
+}
+
+TEST(MeterTest, Weighting) {
+    /* The high pass takes out rumble, and the shelf lifts the treble */
+    dizzy::Meter low(1, rate), high(1, rate);
+    low.process(sine(1, 48000, 20.0f, 0.5f));
+    high.process(sine(1, 48000, 10000.0f, 0.5f));
+
+    float flat = -0.691f + 10.0f * std::log10(0.125f);
+    EXPECT_LT(low.momentary(), flat - 10.0f);
+    EXPECT_THAT(high.momentary(), Near(flat + 4.0f, 0.5f));
+}
+
+TEST(MeterTest, Containers) {
+    /* Odd block sizes and strided spans give the same readings */
+    std::vector<float> x = sine(3, 30000, 440.0f, 0.3f);
+    for (size_t i = 0; i < 30000; i++) {
+        x[3 * i + 2] *= 0.1f;
+    }
+    dizzy::Meter a(3, rate), b(3, rate);
+    a.process(x);
+    for (size_t i = 0; i < x.size(); i += 3 * 1001) {
+        size_t n = std::min(x.size() - i, (size_t) 3 * 1001);
+        dizzy::StridedSpan s(x.data() + i, n, 1);
+        b.process(s);
+    }
+
+    for (size_t c = 0; c < 3; c++) {
+        EXPECT_THAT(b.peak(c), testing::FloatEq(a.peak(c)));
+        EXPECT_THAT(b.truePeak(c), testing::FloatEq(a.truePeak(c)));
+        EXPECT_THAT(b.rms(c), testing::FloatEq(a.rms(c)));
+    }
+    EXPECT_THAT(b.momentary(), testing::FloatEq(a.momentary()));
+    EXPECT_THAT(b.integrated(), testing::FloatEq(a.integrated()));
+}
+
+TEST(MeterTest, NoChannels) {
+    dizzy::Meter meter(0, rate);
+    EXPECT_EQ(meter.numChannels(), 0u);
+    meter.process(sine(1, 4800, 440.0f, 0.5f));
+    EXPECT_EQ(meter.momentary(),
+              -std::numeric_limits<float>::infinity());
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
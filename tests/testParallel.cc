@@ -0,0 +1,142 @@
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/parallel.h"
+
+namespace {
+
+std::vector<float> signal(size_t n, float offset) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = offset + ((i * 7919) % 1000) / 1000.0f;
+    }
+    return x;
+}
+
+}
+
+TEST(ParallelTest, MatchesSerial) {
+    dizzy::parallel::ThreadPool pool(4);
+    dizzy::execution::ParallelPolicy policy(1000, 64, &pool);
+
+    std::vector<float> x = signal(10000, 0.1f), y = signal(10000, 0.5f);
+    std::vector<float> a(10000), b(10000);
+
+    dizzy::mul(policy, a, x, y);
+    dizzy::mul(b, x, y);
+    EXPECT_THAT(a, testing::Eq(b));
+
+    dizzy::pow(policy, a, x, 1.5f);
+    dizzy::pow(b, x, 1.5f);
+    EXPECT_THAT(a, testing::Eq(b));
+
+    dizzy::sqrt(policy, a, x);
+    dizzy::sqrt(b, x);
+    EXPECT_THAT(a, testing::Eq(b));
+
+    dizzy::madd(policy, a, x, y, x);
+    dizzy::madd(b, x, y, x);
+    EXPECT_THAT(a, testing::Eq(b));
+
+    dizzy::approx::exp(policy, a, x, dizzy::approx::MEDIUM);
+    dizzy::approx::exp(b, x, dizzy::approx::MEDIUM);
+    EXPECT_THAT(a, testing::Eq(b));
+
+    std::vector<float> t(10000);
+    for (size_t i = 0; i < t.size(); i++) {
+        t[i] = i * 0.37f;
+    }
+    dizzy::sampleCubic(policy, a, x, t, true);
+    dizzy::sampleCubic(b, x, t, true);
+    EXPECT_THAT(a, testing::Eq(b));
+}
+
+TEST(ParallelTest, Double) {
+    dizzy::parallel::ThreadPool pool(4);
+    dizzy::execution::ParallelPolicy policy(1000, 64, &pool);
+
+    std::vector<double> x(5000), a(5000), b(5000);
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = i * 0.1;
+    }
+
+    dizzy::madd(policy, a, x, x, 1e-12);
+    dizzy::madd(b, x, x, 1e-12);
+    EXPECT_THAT(a, testing::Eq(b));
+
+    dizzy::sin(policy, a, x);
+    dizzy::sin(b, x);
+    EXPECT_THAT(a, testing::Eq(b));
+}
+
+TEST(ParallelTest, ShortestLengthAndTails) {
+    dizzy::parallel::ThreadPool pool(3);
+    dizzy::execution::ParallelPolicy policy(0, 100, &pool);
+
+    std::vector<float> x = signal(1001, 0.0f), y = signal(950, 1.0f);
+    std::vector<float> a(1001, -1.0f);
+
+    dizzy::add(policy, a, x, y);
+    for (size_t i = 0; i < 950; i++) {
+        EXPECT_THAT(a[i], testing::FloatEq(x[i] + y[i]));
+    }
+    EXPECT_THAT(a[950], testing::FloatEq(-1.0f));
+}
+
+TEST(ParallelTest, NonContiguous) {
+    dizzy::parallel::ThreadPool pool(4);
+    dizzy::execution::ParallelPolicy policy(0, 64, &pool);
+
+    std::vector<float> v = signal(3000, 0.2f);
+    std::deque<float> x(v.begin(), v.end()), a(3000);
+
+    dizzy::clamp(policy, a, x, 0.4f, 0.8f);
+    for (size_t i = 0; i < x.size(); i++) {
+        EXPECT_THAT(a[i], testing::FloatEq(std::min(std::max(x[i], 0.4f),
+                                                    0.8f)));
+    }
+}
+
+TEST(ParallelTest, ConcurrentCallers) {
+    dizzy::parallel::ThreadPool pool(2);
+    dizzy::execution::ParallelPolicy policy(0, 256, &pool);
+
+    std::vector<float> x = signal(50000, 0.1f);
+    std::vector<std::vector<float> > out(4, std::vector<float>(50000));
+    std::vector<std::thread> callers;
+    for (size_t c = 0; c < out.size(); c++) {
+        callers.push_back(std::thread([&, c]() {
+            for (int i = 0; i < 20; i++) {
+                dizzy::mul(policy, out[c], x, c + 1.0f);
+            }
+        }));
+    }
+    for (size_t c = 0; c < callers.size(); c++) {
+        callers[c].join();
+    }
+
+    for (size_t c = 0; c < out.size(); c++) {
+        for (size_t i = 0; i < x.size(); i += 97) {
+            EXPECT_THAT(out[c][i], testing::FloatEq(x[i] * (c + 1.0f)));
+        }
+    }
+}
+
+TEST(ParallelTest, DefaultPolicy) {
+    std::vector<float> x = signal(1 << 19, 0.1f), a(x.size()), b(x.size());
+
+    dizzy::sin(dizzy::execution::par, a, x);
+    dizzy::sin(b, x);
+
+    EXPECT_THAT(a, testing::Eq(b));
+    EXPECT_GE(dizzy::parallel::ThreadPool::shared().size(), 1u);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/resampler.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+const double pi = 3.14159265358979;
+
+std::vector<float> sine(size_t n, double frequency) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = std::sin(2.0 * pi * frequency * i);
+    }
+    return x;
+}
+
+/* Largest error of y against the sine it should hold, past the filter's
+ * start up */
+float error(const std::vector<float> &y, size_t count, double frequency) {
+    float e = 0.0f;
+    for (size_t k = 200; k < count; k++) {
+        e = std::max(e, std::fabs(y[k] - (float) std::sin(2.0 * pi *
+                                                          frequency * k)));
+    }
+    return e;
+}
+
+}
+
+TEST(ResamplerTest, Rational) {
+    double rates[][2] = {{44100, 48000}, {48000, 44100}, {48000, 96000},
+                         {96000, 48000}, {44100, 96000}};
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (auto &rate : rates) {
+        std::vector<float> x = sine(20000, 1000.0 / rate[0]);
+        for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+            dizzy::simd::setLevel((dizzy::simd::Level) l);
+            dizzy::Resampler resampler(rate[0], rate[1]);
+            std::vector<float> y(resampler.maxOutput(x.size()));
+            size_t count = resampler.process(y, x);
+
+            /* Every output whose taps have all been read */
+            double ratio = rate[1] / rate[0];
+            size_t expected = (size_t) std::ceil(
+                    (x.size() - resampler.numTaps() / 2) * ratio - 1e-9);
+            EXPECT_EQ(count, expected);
+            EXPECT_THAT(error(y, count, 1000.0 / rate[1]), Near(0.0f, 1e-4));
+        }
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(ResamplerTest, Variable) {
+    /* Irrational ratios, and a fixed ratio switched to a variable one */
+    std::vector<float> x = sine(20000, 0.02);
+    dizzy::Resampler resampler(1.0, std::sqrt(2.0));
+    std::vector<float> y(resampler.maxOutput(x.size()));
+    size_t count = resampler.process(y, x);
+    EXPECT_THAT(error(y, count, 0.02 / std::sqrt(2.0)), Near(0.0f, 1e-4));
+
+    dizzy::Resampler fixed(48000, 44100);
+    std::vector<float> head(x.begin(), x.begin() + 10000);
+    std::vector<float> tail(x.begin() + 10000, x.end());
+    std::vector<float> a(10000), b(10000);
+    size_t first = fixed.process(a, head);
+    fixed.setRatio(0.9);
+    size_t second = fixed.process(b, tail);
+    EXPECT_THAT(second, Near(9000u, 2u));
+
+    /* The output keeps time across the switch */
+    double t = first * 48000.0 / 44100.0;
+    for (size_t k = 0; k < second; k++, t += 1.0 / 0.9) {
+        EXPECT_THAT(b[k], Near((float) std::sin(2.0 * pi * 0.02 * t), 1e-4));
+    }
+}
+
+TEST(ResamplerTest, Aliasing) {
+    /* Halving the rate removes what lies above the new Nyquist frequency
+     * and keeps what lies below */
+    dizzy::Resampler resampler(48000, 24000);
+    std::vector<float> high = sine(20000, 13000.0 / 48000);
+    std::vector<float> y(resampler.maxOutput(high.size()));
+    size_t count = resampler.process(y, high);
+    EXPECT_THAT(error(y, count, 0.0), Near(0.0f, 1e-3));
+
+    resampler.reset();
+    std::vector<float> low = sine(20000, 9000.0 / 48000);
+    count = resampler.process(y, low);
+    EXPECT_THAT(error(y, count, 9000.0 / 24000), Near(0.0f, 1e-3));
+}
+
+TEST(ResamplerTest, Streaming) {
+    /* Odd blocks, full outputs and strided spans give the same samples as
+     * one call */
+    std::vector<float> x = sine(10000, 0.013);
+    dizzy::Resampler a(44100, 48000), b(44100, 48000);
+    std::vector<float> y(a.maxOutput(x.size())), z(y.size());
+    size_t count = a.process(y, x);
+
+    /* Until the outputs pending when dst filled up are all written */
+    size_t read = 0, written = 0, used = 1, produced = 1;
+    while (used || produced) {
+        size_t n = std::min(x.size() - read, (size_t) 777);
+        size_t room = std::min(z.size() - written, (size_t) 300);
+        dizzy::StridedSpan in(x.data() + read, n, 1);
+        dizzy::StridedSpan out(z.data() + written, room, 1);
+        produced = b.process(out, in, &used);
+        written += produced;
+        read += used;
+    }
+    ASSERT_EQ(written, count);
+    for (size_t k = 0; k < count; k++) {
+        EXPECT_EQ(z[k], y[k]);
+    }
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
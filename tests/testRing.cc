@@ -0,0 +1,215 @@
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy.h"
+#include "dizzy/ring.h"
+
+TEST(RingTest, Regions) {
+    dizzy::Ring ring(100);
+    EXPECT_EQ(ring.capacity(), 128u);
+    EXPECT_EQ(ring.writable().size(), 128u);
+    EXPECT_EQ(ring.readable().size(), 0u);
+
+    /* Move the positions near the end so the next regions wrap */
+    std::vector<float> x(100, 1.0f), y(100);
+    EXPECT_EQ(ring.write(x), 100u);
+    EXPECT_EQ(ring.read(y), 100u);
+    dizzy::Ring::Region free = ring.writable();
+    EXPECT_EQ(free.first.size(), 28u);
+    EXPECT_EQ(free.second.size(), 100u);
+    EXPECT_EQ(free.second.begin() + 128, free.first.end());
+
+    for (size_t i = 0; i < 60; i++) {
+        x[i] = i;
+    }
+    EXPECT_EQ(ring.write(std::vector<float>(x.begin(), x.begin() + 60)),
+              60u);
+    dizzy::Ring::Region ready = ring.readable();
+    EXPECT_EQ(ready.first.size(), 28u);
+    EXPECT_EQ(ready.second.size(), 32u);
+    EXPECT_EQ(ring.writable().size(), 68u);
+
+    /* Full rings take nothing and empty ones give nothing */
+    EXPECT_EQ(ring.write(std::vector<float>(100)), 68u);
+    EXPECT_EQ(ring.write(x), 0u);
+    ring.commitRead(ring.readable().size());
+    EXPECT_EQ(ring.read(y), 0u);
+}
+
+TEST(RingTest, InPlace) {
+    /* dizzy functions run on both halves of a wrapped region */
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        dizzy::Ring ring(64);
+        std::vector<float> x(50), y(50);
+        ring.write(x);
+        ring.read(y);
+
+        dizzy::Ring::Region free = ring.writable();
+        dizzy::ramp(free.first, 0.0f, free.first.size() - 1.0f);
+        dizzy::ramp(free.second, 14.0f, 63.0f);
+        ring.commitWrite(40);
+
+        dizzy::Ring::Region ready = ring.readable();
+        EXPECT_EQ(ready.second.size(), 26u);
+        dizzy::mul(ready.first, ready.first, 2.0f);
+        dizzy::mul(ready.second, ready.second, 2.0f);
+        ring.commitRead(ready.size());
+        EXPECT_EQ(ring.readable().size(), 0u);
+        for (size_t i = 0; i < 40; i++) {
+            float z = i < 14 ? ready.first[i] : ready.second[i - 14];
+            EXPECT_FLOAT_EQ(z, 2.0f * i);
+        }
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(RingTest, Threads) {
+    /* A stream passed through a small ring arrives whole and in order */
+    const size_t total = 100000;
+    dizzy::DoubleRing ring(256);
+    std::thread producer([&]() {
+        size_t next = 0;
+        while (next < total) {
+            dizzy::DoubleRing::Region free = ring.writable();
+            size_t n = std::min(free.size(), total - next);
+            for (size_t i = 0; i < n; i++) {
+                size_t j = i < free.first.size() ? i : i - free.first.size();
+                double &z = i < free.first.size() ? free.first[j]
+                                                  : free.second[j];
+                z = next + i;
+            }
+            ring.commitWrite(n);
+            next += n;
+            if (!n) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<double> y(100);
+    size_t next = 0, errors = 0;
+    while (next < total) {
+        size_t n = ring.read(y);
+        for (size_t i = 0; i < n; i++) {
+            errors += y[i] != next + i;
+        }
+        next += n;
+        if (!n) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_EQ(errors, 0u);
+}
+
+TEST(BlockQueueTest, Single) {
+    dizzy::BlockQueue queue(10, 3);
+    EXPECT_EQ(queue.numBlocks(), 4u);
+    EXPECT_TRUE(queue.claimRead().empty());
+
+    std::vector<dizzy::BlockQueue::Block> blocks;
+    for (size_t i = 0; i < 4; i++) {
+        blocks.push_back(queue.claimWrite());
+        EXPECT_EQ(blocks[i].span.size(), 10u);
+        EXPECT_EQ((uintptr_t) blocks[i].span.begin() % 64, 0u);
+    }
+    EXPECT_TRUE(queue.claimWrite().empty());
+
+    /* Blocks come out in the order they were claimed, at their length */
+    for (size_t i = 0; i < 4; i++) {
+        std::fill(blocks[i].span.begin(), blocks[i].span.end(), (float) i);
+    }
+    queue.publish(blocks[1], 5);
+    EXPECT_TRUE(queue.claimRead().empty());
+    queue.publish(blocks[0], 10);
+    dizzy::BlockQueue::Block a = queue.claimRead();
+    dizzy::BlockQueue::Block b = queue.claimRead();
+    EXPECT_TRUE(queue.claimRead().empty());
+    EXPECT_EQ(a.span.size(), 10u);
+    EXPECT_EQ(b.span.size(), 5u);
+    EXPECT_THAT(a.span, testing::Each(0.0f));
+    EXPECT_THAT(b.span, testing::Each(1.0f));
+
+    queue.release(b);
+    EXPECT_TRUE(queue.claimWrite().empty());
+    queue.release(a);
+    EXPECT_FALSE(queue.claimWrite().empty());
+}
+
+TEST(BlockQueueTest, ZeroLength) {
+    /* Claimed blocks holding no samples still count as claimed */
+    dizzy::BlockQueue queue(10, 2);
+    for (size_t i = 0; i < 8; i++) {
+        dizzy::BlockQueue::Block w = queue.claimWrite();
+        EXPECT_FALSE(w.empty());
+        queue.publish(w, 0);
+        dizzy::BlockQueue::Block r = queue.claimRead();
+        EXPECT_FALSE(r.empty());
+        EXPECT_EQ(r.span.size(), 0u);
+        queue.release(r);
+    }
+    EXPECT_TRUE(queue.claimRead().empty());
+
+    dizzy::BlockQueue none(0, 2);
+    for (size_t i = 0; i < 8; i++) {
+        dizzy::BlockQueue::Block w = none.claimWrite();
+        EXPECT_FALSE(w.empty());
+        EXPECT_EQ(w.span.size(), 0u);
+        none.publish(w, 0);
+        none.release(none.claimRead());
+    }
+}
+
+TEST(BlockQueueTest, Threads) {
+    /* Four producers and two consumers pass every value exactly once */
+    const size_t producers = 4, consumers = 2, perProducer = 2000;
+    const size_t total = producers * perProducer;
+    dizzy::BlockQueue queue(16, 8);
+    std::vector<int> seen(total * 16);
+    std::atomic<size_t> received(0);
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.push_back(std::thread([&queue, p]() {
+            for (size_t i = 0; i < perProducer; i++) {
+                dizzy::BlockQueue::Block block;
+                while ((block = queue.claimWrite()).empty()) {
+                    std::this_thread::yield();
+                }
+                float first = (p * perProducer + i) * 16.0f;
+                dizzy::ramp(block.span, first, first + 15.0f);
+                queue.publish(block, 16);
+            }
+        }));
+    }
+    for (size_t c = 0; c < consumers; c++) {
+        threads.push_back(std::thread([&]() {
+            while (received.load() < total) {
+                dizzy::BlockQueue::Block block = queue.claimRead();
+                if (block.empty()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (size_t i = 0; i < block.span.size(); i++) {
+                    seen[(size_t) block.span[i]]++;
+                }
+                queue.release(block);
+                received++;
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    EXPECT_THAT(seen, testing::Each(1));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
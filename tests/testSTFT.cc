@@ -0,0 +1,112 @@
+#include <cmath>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/stft.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+std::vector<float> noise(size_t n) {
+    std::vector<float> x(n);
+    dizzy::Random random(7);
+    random.fill(x, -1.0f, 1.0f);
+    return x;
+}
+
+/* Runs x through stft in blocks of the given sizes in turn */
+std::vector<float> stream(dizzy::STFT &stft, const std::vector<float> &x,
+                          const std::vector<size_t> &blocks) {
+    std::vector<float> y(x.size());
+    for (size_t i = 0, b = 0; i < x.size(); b++) {
+        size_t n = std::min(blocks[b % blocks.size()], x.size() - i);
+        dizzy::Span out(&y[i], n);
+        dizzy::Span in(const_cast<float *>(&x[i]), n);
+        stft.process(out, in);
+        i += n;
+    }
+    return y;
+}
+
+}
+
+TEST(STFTTest, Reconstruction) {
+    /* Untouched spectra give back the input, delayed, for any hop the
+     * window allows and any block sizes */
+    std::vector<float> x = noise(3000);
+    const size_t hops[] = {256, 128, 100, 37};
+    std::vector<size_t> blocks = {1, 64, 333, 17};
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        for (size_t h = 0; h < 4; h++) {
+            size_t frames = 0;
+            dizzy::STFT stft(512, hops[h], [&](dizzy::Span, dizzy::Span) {
+                frames++;
+            });
+            EXPECT_EQ(stft.latency(), 512u);
+            EXPECT_EQ(stft.bins(), 257u);
+            std::vector<float> y = stream(stft, x, blocks);
+            EXPECT_EQ(frames, x.size() / hops[h]);
+            for (size_t i = 0; i < 512; i++) {
+                EXPECT_THAT(y[i], Near(0.0f, 1e-5));
+            }
+            for (size_t i = 512; i < x.size(); i++) {
+                EXPECT_THAT(y[i], Near(x[i - 512], 1e-5));
+            }
+        }
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(STFTTest, Spectrum) {
+    /* Callbacks see the FFT of the windowed frame, and changes to it are
+     * heard */
+    std::vector<float> x = noise(1024), window(256);
+    for (size_t i = 0; i < 256; i++) {
+        window[i] = std::sin(M_PI * (i + 0.5) / 256);
+    }
+    dizzy::FFT fft(256);
+    std::vector<float> frame(256), re(129), im(129);
+    size_t frames = 0;
+    float worst = 0.0f;
+    dizzy::STFT stft(window, 128, [&](dizzy::Span sRe, dizzy::Span sIm) {
+        size_t end = (frames + 1) * 128;
+        for (size_t i = 0; i < 256; i++) {
+            frame[i] = end + i >= 256 ? x[end - 256 + i] * window[i] : 0.0f;
+        }
+        fft.forward(re, im, frame);
+        for (size_t k = 0; k < 129; k++) {
+            worst = std::max(worst, std::fabs(sRe[k] - re[k]));
+            worst = std::max(worst, std::fabs(sIm[k] - im[k]));
+        }
+        frames++;
+        dizzy::mul(sRe, sRe, -0.5f);
+        dizzy::mul(sIm, sIm, -0.5f);
+    });
+    std::vector<float> y(1024);
+    stft.process(y, x);
+    EXPECT_EQ(frames, 8u);
+    EXPECT_LT(worst, 1e-4f);
+    for (size_t i = 256; i < 1024; i++) {
+        EXPECT_THAT(y[i], Near(-0.5f * x[i - 256], 1e-5));
+    }
+
+    /* analyze() runs the same callbacks without producing output */
+    stft.reset();
+    frames = 0;
+    worst = 0.0f;
+    stft.analyze(x);
+    EXPECT_EQ(frames, 8u);
+    EXPECT_LT(worst, 1e-4f);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
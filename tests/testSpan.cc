@@ -0,0 +1,109 @@
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy.h"
+#include "dizzy/expr.h"
+#include "dizzy/fft.h"
+
+TEST(SpanTest, Contiguous) {
+    float x[37], y[37], dst[40];
+    for (size_t i = 0; i < 37; i++) {
+        x[i] = i * 0.5f;
+        y[i] = 2.0f - i;
+    }
+    dst[37] = 0.0f;
+
+    dizzy::Span a(dst, 37), b(x, 37), c(y, y + 37);
+    dizzy::madd(a, b, c, 3.0f);
+
+    for (size_t i = 0; i < 37; i++) {
+        EXPECT_THAT(dst[i], testing::FloatEq(x[i] + y[i] * 3.0f));
+    }
+    EXPECT_THAT(dst[37], testing::FloatEq(0.0f));
+}
+
+TEST(SpanTest, Subspan) {
+    std::vector<float> x = {1, 2, 3, 4, 5, 6, 7, 8};
+    dizzy::Span all(x);
+
+    dizzy::Span middle = all.subspan(2, 4);
+    dizzy::mul(middle, middle, 10.0f);
+
+    EXPECT_EQ(middle.size(), 4u);
+    EXPECT_THAT(x, testing::ElementsAre(1, 2, 30, 40, 50, 60, 7, 8));
+    EXPECT_EQ(all.subspan(6).size(), 2u);
+    EXPECT_EQ(all.subspan(20, 3).size(), 0u);
+}
+
+TEST(SpanTest, StridedChannels) {
+    std::vector<float> frames = {1, -1, 2, -2, 3, -3, 4, -4, 5, -5};
+    dizzy::StridedSpan left(frames.data(), 5, 2);
+    dizzy::StridedSpan right(frames.data() + 1, 5, 2);
+
+    dizzy::add(left, left, right);
+    dizzy::approx::exp(right, right);
+
+    EXPECT_THAT(frames[0], testing::FloatEq(0.0f));
+    EXPECT_THAT(frames[8], testing::FloatEq(0.0f));
+    EXPECT_THAT(frames[3], testing::FloatEq(std::exp(-2.0f)));
+    EXPECT_THAT(frames[9], testing::FloatEq(std::exp(-5.0f)));
+    EXPECT_THAT(dizzy::sum(right), testing::FloatEq(std::exp(-1.0f) +
+        std::exp(-2.0f) + std::exp(-3.0f) + std::exp(-4.0f) +
+        std::exp(-5.0f)));
+}
+
+TEST(SpanTest, PackUnpack) {
+    std::vector<float> device(8, 0.0f), a = {1, 2, 3, 4}, b = {5, 6, 7, 8};
+    dizzy::Span out(device), left(a), right(b);
+
+    dizzy::pack(out, 0, 2, &left, &right);
+    EXPECT_THAT(device, testing::ElementsAre(1, 5, 2, 6, 3, 7, 4, 8));
+
+    std::vector<float> c(4), d(4);
+    dizzy::Span first(c), second(d);
+    dizzy::unpack(out, 0, 2, &second, &first);
+    EXPECT_THAT(c, testing::ElementsAre(5, 6, 7, 8));
+    EXPECT_THAT(d, testing::ElementsAre(1, 2, 3, 4));
+
+    /* Pack into every other frame of a strided view */
+    std::vector<float> e(16, 0.0f);
+    dizzy::StridedSpan pairs(e.data(), 8, 2);
+    dizzy::StridedSpan l(a.data(), 4, 1), r(b.data(), 4, 1);
+    dizzy::pack(pairs, 0, 2, &l, &r);
+    EXPECT_THAT(e, testing::ElementsAre(1, 0, 5, 0, 2, 0, 6, 0,
+                                        3, 0, 7, 0, 4, 0, 8, 0));
+}
+
+TEST(SpanTest, SampleLinear) {
+    std::vector<float> table = {0, 10, 20, 30}, t = {0.5f, 2.25f, 3.5f};
+    std::vector<float> dst(3);
+    dizzy::Span x(table), ts(t), out(dst);
+
+    dizzy::sampleLinear(out, x, ts);
+    EXPECT_THAT(dst, testing::ElementsAre(5, 22.5f, 30));
+
+    dizzy::sampleLinear(out, x, ts, true);
+    EXPECT_THAT(dst[2], testing::FloatEq(15.0f));
+}
+
+TEST(SpanTest, ExprAndFFT) {
+    std::vector<float> x = {1, 2, 3, 4, 5, 6, 7, 8}, y(8);
+    dizzy::Span in(x), out(y);
+
+    dizzy::lazy(out) = dizzy::lazy(in) * 2.0f - 1.0f;
+    EXPECT_THAT(y, testing::ElementsAre(1, 3, 5, 7, 9, 11, 13, 15));
+
+    std::vector<float> re(8), im(8);
+    dizzy::Span sRe(re), sIm(im);
+    dizzy::FFT fft(8);
+    fft.forward(sRe, sIm, in);
+    EXPECT_THAT(re[0], testing::FloatEq(36.0f));
+    EXPECT_THAT(re[4], testing::FloatEq(-4.0f));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
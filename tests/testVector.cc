@@ -1,4 +1,7 @@
+#include <cmath>
+#include <deque>
 #include <limits>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -29,6 +32,224 @@ TEST(SumTest, Value) {
     EXPECT_THAT(b, testing::FloatEq(425607.25));
 }
 
+TEST(SumTest, Double) {
+    std::vector<double> a(1000, 0.1);
+    a[0] = 1e9;
+
+    double b = dizzy::sum(a);
+    double c = dizzy::max(a) + dizzy::min(a);
+
+    EXPECT_THAT(b, testing::DoubleNear(1e9 + 99.9, 1e-6));
+    EXPECT_THAT(c, testing::DoubleEq(1e9 + 0.1));
+
+    std::deque<double> d(a.begin(), a.end());
+    EXPECT_THAT(dizzy::sum(d), testing::DoubleNear(1e9 + 99.9, 1e-6));
+}
+
+TEST(SumTest, Long) {
+    std::vector<float> a(1000000, 0.1f);
+    dizzy::StridedSpan s(a.data(), a.size(), 1);
+
+    /* Adding serially in float stalls far short of this */
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        EXPECT_THAT(dizzy::sum(a), testing::FloatEq(100000.0f));
+        EXPECT_THAT(dizzy::dot(a, a), testing::FloatEq(10000.0f));
+    }
+    dizzy::simd::setLevel(level);
+    EXPECT_THAT(dizzy::sum(s), testing::FloatEq(100000.0f));
+}
+
+TEST(DotTest, Value) {
+    std::vector<float> a(1001), b(1003);
+    double expected = 0.0;
+    for (size_t i = 0; i < b.size(); i++) {
+        b[i] = std::cos(0.01f * i);
+        if (i < a.size()) {
+            a[i] = std::sin(0.37f * i) * 100.0f;
+            expected += (double) a[i] * b[i];
+        }
+    }
+    dizzy::StridedSpan x(a.data(), a.size(), 1), y(b.data(), b.size(), 1);
+
+    EXPECT_THAT(dizzy::dot(a, b), testing::FloatNear(expected, 1e-3));
+    EXPECT_THAT(dizzy::dot(x, y), testing::FloatNear(expected, 1e-3));
+}
+
+TEST(RmsTest, Value) {
+    std::vector<float> a(4096), empty;
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = std::sin(2.0 * 3.14159265358979 * i / 64);
+    }
+
+    EXPECT_THAT(dizzy::rms(a), testing::FloatNear(std::sqrt(0.5f), 1e-6));
+    EXPECT_THAT(dizzy::sumOfSquares(a), testing::FloatNear(2048.0f, 1e-2));
+    EXPECT_THAT(dizzy::rms(empty), testing::FloatEq(0.0f));
+}
+
+TEST(MinMaxTest, Empty) {
+    std::vector<float> a;
+    std::vector<double> b;
+    std::deque<float> c;
+    float inf = std::numeric_limits<float>::infinity();
+
+    EXPECT_THAT(dizzy::min(a), testing::FloatEq(inf));
+    EXPECT_THAT(dizzy::max(a), testing::FloatEq(-inf));
+    EXPECT_THAT(dizzy::min(b), testing::DoubleEq(inf));
+    EXPECT_THAT(dizzy::max(c), testing::FloatEq(-inf));
+    EXPECT_EQ(dizzy::argmin(a), 0u);
+    EXPECT_EQ(dizzy::argmax(c), 0u);
+}
+
+TEST(MinMaxTest, NaN) {
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> a(37, nan), b(37, nan);
+    a[20] = -3.0f;
+    a[30] = 5.0f;
+    std::deque<float> c(a.begin(), a.end());
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        std::pair<float, float> range = dizzy::minmax(a);
+        EXPECT_THAT(range.first, testing::FloatEq(-3.0f));
+        EXPECT_THAT(range.second, testing::FloatEq(5.0f));
+        EXPECT_EQ(dizzy::argmin(a), 20u);
+        EXPECT_EQ(dizzy::argmax(a), 30u);
+        EXPECT_EQ(dizzy::argmax(b), b.size());
+    }
+    dizzy::simd::setLevel(level);
+    EXPECT_THAT(dizzy::minmax(c).first, testing::FloatEq(-3.0f));
+    EXPECT_EQ(dizzy::argmax(c), 30u);
+}
+
+TEST(ArgTest, FirstOccurrence) {
+    /* Lengths around the vector widths and the reduction block, with the
+     * extremes repeated and in the tail */
+    size_t lengths[] = {1, 7, 16, 33, 1023, 1024, 2500};
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (size_t length : lengths) {
+        std::vector<float> a(length);
+        std::vector<double> b(length);
+        for (size_t i = 0; i < length; i++) {
+            a[i] = b[i] = std::sin(0.1 * i);
+        }
+        size_t last = length - 1;
+        a[last] = b[last] = 2.0f;
+        a[last / 2] = b[last / 2] = -2.0f;
+        a[last / 3] = b[last / 3] = -2.0f;
+        std::deque<float> c(a.begin(), a.end());
+
+        for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+            dizzy::simd::setLevel((dizzy::simd::Level) l);
+            EXPECT_EQ(dizzy::argmin(a), last / 3);
+            EXPECT_EQ(dizzy::argmax(a), last);
+            EXPECT_EQ(dizzy::argmin(b), last / 3);
+            EXPECT_EQ(dizzy::argmax(b), last);
+            EXPECT_THAT(dizzy::max(b), testing::DoubleEq(b[last]));
+        }
+        EXPECT_EQ(dizzy::argmin(c), last / 3);
+        EXPECT_EQ(dizzy::argmax(c), last);
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(PackTest, Values) {
+    std::array<float, 9> a={0,0,0,0,0,0,0,0,0}, d={0,1,4,2,5,3,6,0,0};
+    std::array<float, 9> b={1,2,3}, c={4,5,6};
+
+    dizzy::pack(a, 1, 2, &b, &c);
+
+    EXPECT_THAT(a[0], testing::FloatEq(d[0]));
+    EXPECT_THAT(a[1], testing::FloatEq(d[1]));
+    EXPECT_THAT(a[2], testing::FloatEq(d[2]));
+    EXPECT_THAT(a[5], testing::FloatEq(d[5]));
+    EXPECT_THAT(a[6], testing::FloatEq(d[6]));
+    EXPECT_THAT(a[7], testing::FloatEq(d[7]));
+}
+
+TEST(UnpackTest, Values) {
+    std::array<float, 8> a={9,1,2,3,4,5,6,7}, b, c, d;
+
+    dizzy::unpack(a, 1, 3, &b, &c, &d);
+
+    EXPECT_THAT(b[0], testing::FloatEq(1));
+    EXPECT_THAT(c[0], testing::FloatEq(2));
+    EXPECT_THAT(d[0], testing::FloatEq(3));
+    EXPECT_THAT(b[1], testing::FloatEq(4));
+    EXPECT_THAT(c[1], testing::FloatEq(5));
+    EXPECT_THAT(d[1], testing::FloatEq(6));
+}
+
+TEST(PackTest, Layouts) {
+    size_t frames = 301;
+    std::vector<std::vector<float> > channels(10, std::vector<float>(frames));
+    std::vector<const std::vector<float> *> srcs;
+    std::vector<std::vector<float> *> dsts;
+    for (size_t c = 0; c < channels.size(); c++) {
+        for (size_t i = 0; i < frames; i++) {
+            channels[c][i] = c * 1000 + i;
+        }
+        srcs.push_back(&channels[c]);
+        dsts.push_back(&channels[c]);
+    }
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    size_t counts[] = {1, 2, 3, 4, 6, 8, 10};
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        for (size_t n : counts) {
+            for (uint32_t gap = 0; gap < 3; gap += 2) {
+                uint32_t stride = n + gap;
+                std::vector<float> a(1 + frames * stride, -1.0f);
+                dizzy::pack(a, 1, stride, srcs.data(), n);
+                for (size_t i = 0; i < frames; i++) {
+                    for (size_t c = 0; c < stride; c++) {
+                        float expected = c < n ? c * 1000 + i : -1.0f;
+                        EXPECT_EQ(a[1 + i * stride + c], expected);
+                    }
+                }
+
+                std::vector<std::vector<float> > b(n,
+                    std::vector<float>(frames));
+                std::vector<std::vector<float> *> bs;
+                for (size_t c = 0; c < n; c++) {
+                    bs.push_back(&b[c]);
+                }
+                dizzy::unpack(a, 1, stride, bs.data(), n);
+                for (size_t c = 0; c < n; c++) {
+                    EXPECT_EQ(b[c], channels[c]);
+                }
+            }
+        }
+    }
+    dizzy::simd::setLevel(level);
+}
+
+TEST(PackTest, Spans) {
+    std::vector<float> x = {1, 2, 3}, y = {4, 5, 6}, z(6), w(6);
+    dizzy::Span xs(x), ys(y), zs(z);
+    dizzy::StridedSpan xt(x.data(), 3, 1), yt(y.data(), 3, 1),
+                       wt(w.data(), 6, 1);
+
+    dizzy::pack(zs, 0, 2, &xs, &ys);
+    dizzy::pack(wt, 0, 2, &xt, &yt);
+    EXPECT_THAT(z, testing::ElementsAre(1, 4, 2, 5, 3, 6));
+    EXPECT_EQ(w, z);
+}
+
+TEST(PackTest, Bounds) {
+    /* Overlapping frames stop where the last channel would overrun */
+    std::vector<float> a(5, 0.0f), x = {1, 2, 3, 4, 5}, y = {6, 7, 8, 9, 10};
+    std::vector<float> b(2);
+    dizzy::pack(a, 0, 1, &x, &y);
+    EXPECT_THAT(a, testing::ElementsAre(1, 6, 7, 8, 9));
+
+    dizzy::unpack(a, 3, 2, &b);
+    EXPECT_THAT(b, testing::ElementsAre(8, 0));
+}
+
 int main(int argc, char** argv) {
     testing::InitGoogleMock(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,124 @@
+#include <cmath>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/wavetable.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+namespace {
+
+std::vector<float> saw(size_t n) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = 2.0f * i / n - 1.0f;
+    }
+    return x;
+}
+
+std::vector<float> phases(size_t n, float start, float increment) {
+    std::vector<float> t(n);
+    for (size_t i = 0; i < n; i++) {
+        t[i] = start + i * increment;
+    }
+    return t;
+}
+
+}
+
+TEST(WavetableTest, Sine) {
+    std::vector<float> x(600);
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = std::sin(2.0 * dizzy::fft::pi * i / x.size());
+    }
+
+    dizzy::Wavetable table(x, 2000);
+    ASSERT_EQ(table.size(), 2048u);
+    ASSERT_EQ(table.levels(), 10u);
+    for (size_t l = 0; l < table.levels(); l++) {
+        for (size_t i = 0; i < table.size(); i += 17) {
+            float expected = std::sin(2.0 * dizzy::fft::pi * i / 2048);
+            EXPECT_THAT(table.level(l)[i], Near(expected, 1e-4));
+        }
+    }
+}
+
+TEST(WavetableTest, BandLimits) {
+    dizzy::Wavetable table(saw(1000), 1024);
+    dizzy::FFT fft(1024);
+    std::vector<float> re(513), im(513), reference(513);
+
+    fft.forward(reference, im, table.level(0));
+    for (size_t l = 0; l < table.levels(); l++) {
+        fft.forward(re, im, table.level(l));
+        size_t limit = 512 >> l;
+        for (size_t h = 0; h < 513; h++) {
+            float magnitude = std::hypot(re[h], im[h]);
+            if (h >= limit) {
+                EXPECT_THAT(magnitude, Near(0.0f, 1e-2));
+            }
+            else if (h > 0) {
+                /* The saw's harmonics fall off as 1 / h */
+                EXPECT_THAT(magnitude, Near(1024.0f / (dizzy::fft::pi * h),
+                                            2.0f));
+            }
+        }
+    }
+}
+
+TEST(WavetableTest, Levels) {
+    dizzy::Wavetable table(saw(256), 256);
+    std::vector<float> t = phases(300, -50.0f, 0.4f), a(300), b(300), c(300);
+
+    /* Slow phases read level 0 alone */
+    table.process(a, t, 0.4f);
+    std::vector<float> level0 = table.level(0);
+    dizzy::sampleCubic(b, level0, t, true);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(a[i], Near(b[i], 1e-5));
+    }
+
+    /* Halfway through the octave from 4 to 8 mixes levels 3 and 4 equally */
+    table.process(a, t, std::pow(2.0f, 2.5f));
+    std::vector<float> level3 = table.level(3), level4 = table.level(4);
+    dizzy::sampleCubic(b, level3, t, true);
+    dizzy::sampleCubic(c, level4, t, true);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(a[i], Near(0.5f * (b[i] + c[i]), 1e-5));
+    }
+
+    /* Increments past the last level stay on it */
+    table.process(a, t, 1e6f);
+    std::vector<float> last = table.level(table.levels() - 1);
+    dizzy::sampleCubic(b, last, t, true);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(a[i], Near(b[i], 1e-5));
+    }
+}
+
+TEST(WavetableTest, Containers) {
+    dizzy::Wavetable table(saw(100), 128);
+    std::vector<float> t = phases(700, 3.0f, 2.7f), a(700), b(700);
+    table.process(a, t, 2.7f);
+
+    dizzy::StridedSpan ts(t.data(), t.size(), 1), bs(b.data(), b.size(), 1);
+    table.process(bs, ts, 2.7f);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(b[i], testing::FloatEq(a[i]));
+    }
+
+    /* In place */
+    table.process(t, t, 2.7f);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_THAT(t[i], testing::FloatEq(a[i]));
+    }
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}
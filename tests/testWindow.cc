@@ -0,0 +1,143 @@
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dizzy/window.h"
+
+MATCHER_P2(Near, expected, error, "") {
+  return expected - error <= arg && arg <= expected + error;
+}
+
+TEST(WindowTest, Shapes) {
+    /* Periodic windows against their definitions */
+    const size_t n = 64;
+    const dizzy::Window::Type types[] = {
+        dizzy::Window::HANN, dizzy::Window::HAMMING,
+        dizzy::Window::BLACKMAN_HARRIS, dizzy::Window::FLAT_TOP};
+    const double terms[][5] = {
+        {0.5, 0.5, 0.0, 0.0, 0.0},
+        {0.54, 0.46, 0.0, 0.0, 0.0},
+        {0.35875, 0.48829, 0.14128, 0.01168, 0.0},
+        {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368}};
+    for (size_t t = 0; t < 4; t++) {
+        dizzy::Window window(types[t], n);
+        ASSERT_EQ(window.size(), n);
+        for (size_t i = 0; i < n; i++) {
+            double phase = 2.0 * M_PI * i / n, w = 0.0;
+            for (size_t k = 0; k < 5; k++) {
+                w += (k % 2 ? -1.0 : 1.0) * terms[t][k] * std::cos(k * phase);
+            }
+            EXPECT_THAT(window.doubleCoefficients()[i], Near(w, 1e-12));
+            EXPECT_FLOAT_EQ(window.coefficients()[i], w);
+        }
+    }
+
+    /* Periodic Hann windows overlapped by half sum to one */
+    dizzy::Window hann(dizzy::Window::HANN, n);
+    for (size_t i = 0; i < n / 2; i++) {
+        EXPECT_THAT(hann.coefficients()[i] + hann.coefficients()[i + n / 2],
+                    Near(1.0f, 1e-6));
+    }
+
+    /* Symmetric windows end where they start, and Kaiser peaks at one */
+    dizzy::Window kaiser(dizzy::Window::KAISER, 33,
+                         dizzy::Window::SYMMETRIC, 5.0);
+    const std::vector<double> &k = kaiser.doubleCoefficients();
+    for (size_t i = 0; i < 33; i++) {
+        EXPECT_THAT(k[i], Near(k[32 - i], 1e-12));
+        EXPECT_LE(k[i], 1.0 + 1e-12);
+    }
+    EXPECT_THAT(k[16], Near(1.0, 1e-12));
+    EXPECT_THAT(k[0], Near(1.0 / dizzy::detail::besselI0(5.0), 1e-12));
+}
+
+TEST(WindowTest, SingleSample) {
+    /* Every type and symmetry of one sample passes it through */
+    for (int t = dizzy::Window::HANN; t <= dizzy::Window::FLAT_TOP; t++) {
+        for (int s = dizzy::Window::PERIODIC; s <= dizzy::Window::SYMMETRIC;
+             s++) {
+            dizzy::Window w((dizzy::Window::Type) t, 1,
+                            (dizzy::Window::Symmetry) s);
+            EXPECT_EQ(w.coefficients()[0], 1.0f);
+        }
+    }
+}
+
+TEST(WindowTest, Cache) {
+    /* One table per type, size, symmetry and Kaiser beta, however many
+     * threads ask for it */
+    std::shared_ptr<const dizzy::Window> a =
+            dizzy::Window::get(dizzy::Window::HANN, 256);
+    EXPECT_EQ(dizzy::Window::get(dizzy::Window::HANN, 256), a);
+    EXPECT_EQ(dizzy::Window::get(dizzy::Window::HANN, 256,
+                                 dizzy::Window::PERIODIC, 3.0), a);
+    EXPECT_NE(dizzy::Window::get(dizzy::Window::HANN, 128), a);
+    EXPECT_NE(dizzy::Window::get(dizzy::Window::HANN, 256,
+                                 dizzy::Window::SYMMETRIC), a);
+    EXPECT_NE(dizzy::Window::get(dizzy::Window::KAISER, 256,
+                                 dizzy::Window::PERIODIC, 3.0),
+              dizzy::Window::get(dizzy::Window::KAISER, 256,
+                                 dizzy::Window::PERIODIC, 4.0));
+
+    std::vector<std::shared_ptr<const dizzy::Window> > got(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < got.size(); t++) {
+        threads.push_back(std::thread([&got, t]() {
+            got[t] = dizzy::Window::get(dizzy::Window::BLACKMAN_HARRIS, 512);
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    EXPECT_THAT(got, testing::Each(got[0]));
+}
+
+TEST(WindowTest, Apply) {
+    /* apply() matches mul() by the table for every container */
+    std::shared_ptr<const dizzy::Window> window =
+            dizzy::Window::get(dizzy::Window::BLACKMAN_HARRIS, 100);
+    std::vector<float> x(120), expected(100);
+    dizzy::Random random(3);
+    random.fill(x, -1.0f, 1.0f);
+    std::vector<float> head(x.begin(), x.begin() + 100);
+    dizzy::mul(expected, head, window->coefficients());
+
+    dizzy::simd::Level level = dizzy::simd::level();
+    for (int l = dizzy::simd::SCALAR; l <= dizzy::simd::detect(); l++) {
+        dizzy::simd::setLevel((dizzy::simd::Level) l);
+        std::vector<float> y(120, 5.0f);
+        window->apply(y, x);
+        for (size_t i = 0; i < 100; i++) {
+            EXPECT_EQ(y[i], expected[i]);
+        }
+        EXPECT_EQ(y[100], 5.0f);
+
+        std::vector<float> z(100);
+        dizzy::Span zSpan(z), xSpan(x);
+        window->apply(zSpan, xSpan);
+        EXPECT_EQ(z, expected);
+
+        std::vector<float> interleaved(200);
+        dizzy::StridedSpan odd(&interleaved[1], 100, 2);
+        dizzy::StridedSpan source(&x[0], 100, 1);
+        window->apply(odd, source);
+        for (size_t i = 0; i < 100; i++) {
+            EXPECT_EQ(interleaved[2 * i + 1], expected[i]);
+        }
+
+        std::vector<double> xd(x.begin(), x.end()), yd(100);
+        window->apply(yd, xd);
+        for (size_t i = 0; i < 100; i++) {
+            EXPECT_EQ(yd[i], xd[i] * window->doubleCoefficients()[i]);
+        }
+    }
+    dizzy::simd::setLevel(level);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleMock(&argc, argv);
+    return RUN_ALL_TESTS();
+}